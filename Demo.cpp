@@ -6,6 +6,8 @@
 #include "complex.hpp"
 #include "node.hpp"
 #include "tree.hpp"
+#include "tree_gui.hpp"
+#include "tree_viewer.hpp"
 
 using namespace std;
 
@@ -178,9 +180,18 @@ int main(){
      *  1.5      1.6
      */
 
-    // Should print the graph using GUI.
-    cout << tree;
-    cout << cTree;
-    cout << three_ary_tree;
+    // Should show the graphs using GUI, without blocking: both double trees side by side in one window,
+    // the complex tree in a second window.
+    TreeViewer<double> viewer("EX2 - doubles");
+    viewer.show(tree, 0);
+    viewer.show(three_ary_tree, 1);
+    TreeViewer<Complex> complex_viewer("EX2 - complex");
+    complex_viewer.show(cTree);
+
+    three_ary_tree.add_sub_node(n3, Node(1.7));  // The trees stay usable; show() again to update the window.
+    viewer.show(three_ary_tree, 1);
+
+    viewer.wait();
+    complex_viewer.wait();
 
 }
\ No newline at end of file
@@ -0,0 +1,535 @@
+/**
+ * Micro benchmarks for the tree. Usage: ./bench [node_count]
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+
+#include "complex.hpp"
+#include "complex_array.hpp"
+#include "node.hpp"
+#include "tree.hpp"
+#include "mapped_tree.hpp"
+#include "louds_tree.hpp"
+#include "edge_list_importer.hpp"
+#include "layout_grid.hpp"
+
+using namespace std;
+
+// Measures the wall time of a callable in milliseconds.
+template <typename F>
+double time_ms(F &&f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Fills an empty tree with count nodes in BFS order, each node holding its BFS index.
+template <int K>
+void build_complete_tree(Tree<int, K> &tree, size_t count) {
+    vector<Node<int> *> nodes;
+    nodes.reserve(count);
+    nodes.push_back(tree.emplace_root(0));
+    for (size_t i = 1; i < count; i++) {
+        nodes.push_back(nodes[(i - 1) / K]->emplace_child(static_cast<int>(i)));
+    }
+}
+
+void bench_serialization(size_t count) {
+    Tree<int> tree;
+    double build = time_ms([&] { build_complete_tree(tree, count); });
+
+    stringstream buffer;
+    double save = time_ms([&] { tree.save(buffer); });
+
+    Tree<int> loaded;
+    double load = time_ms([&] { loaded.load(buffer); });
+
+    size_t small = 20000;  // add_sub_node searches from the root, so keep this rebuild small.
+    Tree<int> rebuilt;
+    double rebuild = time_ms([&] {
+        rebuilt.add_root(Node<int>(0));
+        for (size_t i = 1; i < small; i++) {
+            rebuilt.add_sub_node(Node<int>(static_cast<int>((i - 1) / 2)), Node<int>(static_cast<int>(i)));
+        }
+    });
+
+    cout << "serialization (" << count << " nodes, " << buffer.str().size() << " bytes)" << endl;
+    cout << "  direct build:          " << build << " ms" << endl;
+    cout << "  save:                  " << save << " ms" << endl;
+    cout << "  load:                  " << load << " ms" << endl;
+    cout << "  add_sub_node rebuild:  " << rebuild << " ms for only " << small << " nodes" << endl;
+}
+
+void bench_mapped(size_t count) {
+    const string path = "bench_mapped_tree.bin";
+    {
+        Tree<int> tree;
+        build_complete_tree(tree, count);
+        ofstream file(path, ios::binary);
+        MappedTree<int>::write(tree, file);
+    }
+
+    long long sum = 0;
+    double open_time = 0, scan_time = 0;
+    {
+        open_time = time_ms([&] { MappedTree<int> probe(path); });
+        MappedTree<int> mapped(path);
+        scan_time = time_ms([&] {
+            for (auto it = mapped.begin_bfs_scan(); it != mapped.end_bfs_scan(); ++it) sum += it->get_value();
+        });
+    }
+    remove(path.c_str());
+
+    cout << "memory-mapped tree (" << count << " nodes)" << endl;
+    cout << "  open:                  " << open_time << " ms" << endl;
+    cout << "  first BFS scan:        " << scan_time << " ms (checksum " << sum << ")" << endl;
+}
+
+void bench_louds(size_t count) {
+    Tree<int, 3> tree;
+    build_complete_tree(tree, count);
+
+    unique_ptr<LoudsTree<int, 3>> louds;
+    double build = time_ms([&] { louds = make_unique<LoudsTree<int, 3>>(tree); });
+
+    size_t visited = 0;
+    double walk = time_ms([&] {  // Climb from every node to the root.
+        for (uint32_t i = 0; i < louds->size(); i++) {
+            for (uint32_t p = i; p != LoudsTree<int, 3>::NONE; p = louds->parent(p)) visited++;
+        }
+    });
+
+    cout << "LOUDS tree (" << count << " nodes, K = 3)" << endl;
+    cout << "  build:                 " << build << " ms" << endl;
+    cout << "  pointer layout:        " << LoudsTree<int, 3>::pointer_layout_bytes(tree) / 1e6 << " MB" << endl;
+    cout << "  LOUDS + values:        " << louds->memory_bytes() / 1e6 << " MB" << endl;
+    cout << "  parent walks:          " << walk << " ms for " << visited << " steps" << endl;
+}
+
+void bench_edge_import(size_t count) {
+    const string path = "bench_edges.txt";
+    {
+        ofstream file(path);
+        for (size_t i = 1; i < count; i++) file << (i - 1) / 2 << ',' << i << '\n';
+    }
+
+    Tree<int> imported;
+    double import_time = time_ms([&] { import_edge_list(path, imported); });
+
+    size_t small = 20000;
+    Tree<int> naive;
+    double naive_time = time_ms([&] {  // Line-by-line iostream parsing plus add_sub_node per edge.
+        ifstream file(path);
+        int parent, child;
+        char comma;
+        naive.add_root(Node<int>(0));
+        for (size_t i = 1; i < small && file >> parent >> comma >> child; i++) {
+            naive.add_sub_node(Node<int>(parent), Node<int>(child));
+        }
+    });
+    remove(path.c_str());
+
+    cout << "edge list import (" << count << " nodes, " << thread::hardware_concurrency() << " threads)" << endl;
+    cout << "  import_edge_list:      " << import_time << " ms" << endl;
+    cout << "  iostream+add_sub_node: " << naive_time << " ms for only " << small << " nodes" << endl;
+}
+
+void bench_layout(size_t count) {
+    Tree<int> tree;
+    build_complete_tree(tree, count);
+
+    double first = time_ms([&] { tree.get_layout(750); });
+    const int frames = 600;
+    double cached = time_ms([&] {
+        for (int i = 0; i < frames; i++) tree.get_layout(750);
+    });
+
+    cout << "layout (" << count << " nodes)" << endl;
+    cout << "  compute once:          " << first << " ms" << endl;
+    cout << "  cached, per frame:     " << cached * 1000 / frames << " us" << endl;
+
+    const size_t million = 1000000;  // Tidy layout at 1M nodes: wide (3-ary) and deep (a single path).
+    Tree<int, 3> wide;
+    build_complete_tree(wide, million);
+    double wide_ms = time_ms([&] { wide.get_layout(750); });
+    Tree<int> deep;
+    Node<int> *curr = deep.emplace_root(0);
+    for (size_t i = 1; i < million; i++) curr = curr->emplace_child(static_cast<int>(i));
+    deep.mark_changed();
+    double deep_ms = time_ms([&] { deep.get_layout(750); });
+    cout << "  1M nodes, 3-ary:       " << wide_ms << " ms" << endl;
+    cout << "  1M nodes, one path:    " << deep_ms << " ms" << endl;
+}
+
+void bench_export(size_t count) {
+    Tree<int, 3> tree;
+    build_complete_tree(tree, count);
+    tree.get_layout(750);  // Time the export only.
+    ofstream out("/dev/null", ios::binary);
+    double svg = time_ms([&] { tree.export_svg(out); });
+
+    cout << "headless export (" << count << " nodes)" << endl;
+    cout << "  export_svg:            " << svg << " ms" << endl;
+
+    const string path = "bench_export.txt";  // Text outputs go to a real file to compare with disk bandwidth.
+    auto text_output = [&](const char *name, auto write) {
+        double ms = time_ms([&] {
+            ofstream file(path, ios::binary);
+            write(file);
+        });
+        ifstream written(path, ios::binary | ios::ate);
+        double megabytes = static_cast<double>(written.tellg()) / (1 << 20);
+        cout << "  " << name << ms << " ms, " << megabytes * 1000 / ms << " MB/s" << endl;
+    };
+    text_output("write_ascii:           ", [&](ostream &os) { tree.write_ascii(os); });
+    text_output("write_dot:             ", [&](ostream &os) { tree.write_dot(os); });
+    text_output("write_csv:             ", [&](ostream &os) { tree.write_csv(os); });
+    text_output("ostream << per node:   ", [&](ostream &os) {  // What a plain iostream dump costs.
+        for (auto node = tree.begin_pre_order(); node != tree.end_pre_order(); ++node) os << node->get_value() << '\n';
+    });
+    remove(path.c_str());
+}
+
+void bench_complex_heap(size_t count) {
+    Tree<Complex> tree;
+    Node<Complex> *root = tree.emplace_root(0.0, 0.0);
+    vector<Node<Complex> *> nodes = {root};
+    nodes.reserve(count);
+    uint64_t seed = 42;
+    for (size_t i = 1; i < count; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;  // Scattered magnitudes.
+        double re = static_cast<double>(seed >> 40) / 1024, im = static_cast<double>((seed >> 16) & 0xffffff) / 1024;
+        nodes.push_back(nodes[(i - 1) / 2]->emplace_child(re, im));
+    }
+    tree.mark_changed();
+
+    double sum = 0;
+    double heap = time_ms([&] {
+        for (auto node = tree.begin_heap(); node != tree.end_heap(); ++node) sum += node->get_value().get_real();
+    });
+
+    vector<Node<Complex> *> batched;
+    double soa_heap = time_ms([&] { batched = heap_order(tree); });
+
+    vector<Node<Complex> *> nodes_in_order;
+    ComplexArray values = gather_values(tree, nodes_in_order);
+    AlignedDoubles keys(values.size());
+    double scalar_keys = time_ms([&] { magnitudes(values, keys.data(), SimdLevel::SCALAR); });
+    double simd_keys = time_ms([&] { magnitudes(values, keys.data()); });
+    double per_value = time_ms([&] {  // One Complex at a time through the node pointers.
+        for (size_t i = 0; i < nodes_in_order.size(); i++) keys[i] = nodes_in_order[i]->get_value().Magnitude();
+    });
+    ComplexArray product;
+    double simd_multiply = time_ms([&] { multiply(values, Complex(0.5, 0.5), product); });
+
+    cout << "complex heap traversal (" << count << " nodes)" << endl;
+    cout << "  begin_heap + scan:     " << heap << " ms (checksum " << sum << ")" << endl;
+    cout << "  heap_order (SoA keys): " << soa_heap << " ms" << endl;
+    cout << "  magnitudes, per node:  " << per_value << " ms" << endl;
+    cout << "  magnitudes, scalar SoA: " << scalar_keys << " ms" << endl;
+    cout << "  magnitudes, " << (simd_level() == SimdLevel::AVX2 ? "AVX2" : simd_level() == SimdLevel::SSE2 ? "SSE2" : "scalar")
+         << " SoA:  " << simd_keys << " ms" << endl;
+    cout << "  multiply, SIMD SoA:    " << simd_multiply << " ms" << endl;
+}
+
+void bench_find(size_t count) {
+    Tree<int, 3> tree;
+    build_complete_tree(tree, count);
+    tree.enable_value_scan();
+    const int lookups = 20;
+    size_t hits = 0;  // Used in the output, so no lookup can be optimized away.
+
+    double recursive = time_ms([&] {  // A change before each lookup keeps find_node on the pointer walk.
+        for (int i = 0; i < lookups; i++) {
+            tree.mark_changed();
+            hits += tree.find_node(-1) != nullptr;
+        }
+    }) / lookups;
+    double copy = time_ms([&] {
+        tree.find_node(-1);
+        hits += tree.find_node(-1) != nullptr;  // Second lookup without a change: builds the flat copy.
+    });
+    double scan = time_ms([&] {
+        for (int i = 0; i < lookups; i++) hits += tree.find_node(-1) != nullptr;
+    }) / lookups;
+    size_t matches = 0;
+    double all = time_ms([&] {
+        for (int i = 0; i < lookups; i++) matches += tree.find_all(static_cast<int>(count - 1)).size();
+    }) / lookups;
+
+    cout << "find_node miss (" << count << " int nodes)" << endl;
+    cout << "  recursive:       " << recursive << " ms" << endl;
+    cout << "  build flat copy: " << copy << " ms" << endl;
+    cout << "  " << (simd_level() == SimdLevel::AVX2 ? "AVX2" : simd_level() == SimdLevel::SSE2 ? "SSE2" : "scalar")
+         << " scan:       " << scan << " ms (" << hits << " hits)" << endl;
+    cout << "  find_all:        " << all << " ms (" << matches / lookups << " match)" << endl;
+}
+
+void bench_summary(size_t count) {
+    Tree<int, 3> tree;
+    build_complete_tree(tree, count);
+    vector<Node<int> *> order;  // Renumber in pre-order, so every subtree holds one interval of values.
+    for (auto node = tree.begin_pre_order(); node != tree.end_pre_order(); ++node) order.push_back(&*node);
+    for (size_t i = 0; i < order.size(); i++) tree.set_value(order[i], static_cast<int>(i));
+    const int lookups = 20;
+    int key = static_cast<int>(count - 1);  // The last node in pre-order: the worst case of the plain search.
+    size_t hits = 0;  // Used in the output, so no lookup can be optimized away.
+    tree.enable_value_scan();
+
+    double recursive = time_ms([&] {
+        for (int i = 0; i < lookups; i++) {
+            tree.mark_changed();  // Keeps find_node off the flat scan.
+            hits += tree.find_node(key) != nullptr;
+        }
+    }) / lookups;
+    tree.find_node(key);
+    double scan = time_ms([&] {
+        for (int i = 0; i < lookups; i++) hits += tree.find_node(key) != nullptr;
+    }) / lookups;
+    size_t matches = 0;
+    double range = time_ms([&] {
+        for (int i = 0; i < lookups; i++) matches += tree.find_in_range(key / 2, key / 2 + 100).size();
+    }) / lookups;
+
+    tree.enable_summaries();
+    double rebuild = time_ms([&] { tree.find_node(key); });
+    double pruned = time_ms([&] {
+        for (int i = 0; i < lookups; i++) hits += tree.find_node(key) != nullptr;
+    }) / lookups;
+    double pruned_range = time_ms([&] {
+        for (int i = 0; i < lookups; i++) matches += tree.find_in_range(key / 2, key / 2 + 100).size();
+    }) / lookups;
+
+    cout << "subtree summaries (" << count << " int nodes, values clustered by subtree)" << endl;
+    cout << "  find_node, recursive:     " << recursive << " ms" << endl;
+    cout << "  find_node, SIMD scan:     " << scan << " ms" << endl;
+    cout << "  find_node, pruned:        " << pruned << " ms (" << hits << " hits)" << endl;
+    cout << "  find_in_range, full walk: " << range << " ms" << endl;
+    cout << "  find_in_range, pruned:    " << pruned_range << " ms (" << matches / (2 * lookups) << " nodes)" << endl;
+    cout << "  summary build:            " << rebuild << " ms" << endl;
+}
+
+void bench_bloom(size_t count) {
+    Tree<string, 3> tree;
+    vector<Node<string> *> nodes = {tree.emplace_root("key0")};
+    nodes.reserve(count);
+    for (size_t i = 1; i < count; i++) nodes.push_back(nodes[(i - 1) / 3]->emplace_child("key" + to_string(i)));
+    tree.mark_changed();
+    size_t value_bytes = 0;
+    for (Node<string> *node : nodes) value_bytes += sizeof(Node<string>) + node->get_value().capacity() + sizeof(Node<string> *);
+    const int lookups = 20;
+    size_t hits = 0;  // Used in the output, so no lookup can be optimized away.
+
+    double plain = time_ms([&] {
+        for (int i = 0; i < lookups; i++) hits += tree.find_node("missing" + to_string(i)) != nullptr;
+    }) / lookups;
+    cout << "bloom filters (" << count << " string nodes, " << value_bytes / (1 << 20) << " MB of nodes)" << endl;
+    cout << "  find_node miss, plain:  " << plain << " ms" << endl;
+
+    for (size_t min_size : {64, 256, 1024}) {
+        tree.enable_bloom_filters(min_size, 10);
+        double build = time_ms([&] { tree.get_bloom_filters(); });
+        const SubtreeBloom<string> &blooms = tree.get_bloom_filters();
+        double miss = time_ms([&] {
+            for (int i = 0; i < lookups; i++) hits += tree.find_node("missing" + to_string(i)) != nullptr;
+        }) / lookups;
+        double hit = time_ms([&] {
+            for (int i = 0; i < lookups; i++) hits += tree.find_node(nodes[count - 1 - i]->get_value()) != nullptr;
+        }) / lookups;
+
+        size_t positives = 0, checks = 0;  // Absent keys each filter lets through.
+        for (int i = 0; i < 1000; i++) {
+            uint64_t hash = SubtreeBloom<string>::hash_of("absent" + to_string(i));
+            for (const auto &entry : blooms.get_filters()) positives += entry.second.may_contain(hash);
+            checks += blooms.get_filters().size();
+        }
+        cout << "  subtrees >= " << min_size << ": " << blooms.get_filters().size() << " filters, "
+             << blooms.memory_bytes() / (1 << 20) << " MB, false positives " << 100.0 * positives / max<size_t>(checks, 1)
+             << "%, build " << build << " ms" << endl;
+        cout << "    find_node miss: " << miss << " ms, hit: " << hit << " ms" << endl;
+    }
+    cout << "  (" << hits << " hits)" << endl;
+}
+
+void bench_shape(size_t count) {
+    Tree<int, 3> tree;
+    build_complete_tree(tree, count);
+    tree.mark_changed();
+    size_t total = 0;  // Used in the output, so no call can be optimized away.
+
+    double walk_size = time_ms([&] { total += tree.size() + tree.height(); });
+    double walk_at = time_ms([&] { total += tree.node_at(count - 1)->get_value(); });
+    tree.enable_shape_tracking();
+    double build = time_ms([&] { total += tree.size(); });
+    double tracked_size = time_ms([&] { total += tree.size() + tree.height(); });
+    const int draws = 100000;
+    mt19937_64 rng(1);
+    double sample = time_ms([&] {
+        for (int i = 0; i < draws; i++) total += tree.random_node(rng)->get_value();
+    });
+
+    cout << "subtree shape (" << count << " nodes)" << endl;
+    cout << "  size + height, traversal: " << walk_size << " ms" << endl;
+    cout << "  size + height, tracked:   " << tracked_size * 1000 << " us" << endl;
+    cout << "  last node in pre-order, traversal: " << walk_at << " ms" << endl;
+    cout << "  random_node, tracked:     " << sample * 1000 / draws << " us per draw" << endl;
+    cout << "  shape build:              " << build << " ms (checksum " << total << ")" << endl;
+}
+
+void bench_intervals(size_t count) {
+    Tree<int, 3> tree;
+    vector<Node<int> *> nodes = {tree.emplace_root(0)};
+    nodes.reserve(count);
+    for (size_t i = 1; i < count; i++) nodes.push_back(nodes[(i - 1) / 3]->emplace_child(static_cast<int>(i)));
+    tree.mark_changed();
+    mt19937_64 rng(1);
+    const int queries = 1000000;
+    vector<pair<Node<int> *, Node<int> *>> pairs(queries);  // (ancestor candidate near the top, any node)
+    for (auto &query : pairs) query = {nodes[rng() % min<size_t>(count, 1000)], nodes[rng() % count]};
+    size_t under = 0;  // Used in the output, so no query can be optimized away.
+
+    double search = time_ms([&] {  // Today's check: search the candidate's subtree for the node's value.
+        for (int i = 0; i < 20; i++) under += tree.find_node(pairs[i].first, pairs[i].second->get_value()) != nullptr;
+    }) / 20;
+    double build = time_ms([&] { tree.get_interval_index(); });
+    double indexed = time_ms([&] {
+        for (const auto &query : pairs) under += tree.is_ancestor(query.first, query.second);
+    });
+    size_t visited = 0;
+    double slice = time_ms([&] {
+        for (Node<int> *node : tree.subtree_nodes(nodes[1])) visited += node->get_value() & 1;
+    });
+
+    cout << "interval index (" << count << " nodes)" << endl;
+    cout << "  is_ancestor via find_node: " << search * 1000 << " us per query" << endl;
+    cout << "  is_ancestor via index:     " << indexed * 1e6 / queries << " ns per query (" << under << " true)" << endl;
+    cout << "  index build:               " << build << " ms" << endl;
+    cout << "  subtree slice of " << tree.descendant_count(nodes[1]) + 1 << " nodes: " << slice << " ms (" << visited << " odd)" << endl;
+}
+
+void bench_lca(size_t count) {
+    Tree<int, 3> tree;
+    vector<Node<int> *> nodes = {tree.emplace_root(0)};
+    nodes.reserve(count);
+    for (size_t i = 1; i < count; i++) nodes.push_back(nodes[(i - 1) / 3]->emplace_child(static_cast<int>(i)));
+    tree.mark_changed();
+    mt19937_64 rng(2);
+    const int queries = 1000000;
+    vector<pair<Node<int> *, Node<int> *>> pairs(queries);
+    for (auto &query : pairs) query = {nodes[rng() % count], nodes[rng() % count]};
+    size_t checksum = 0;  // Used in the output, so no query can be optimized away.
+
+    double paths = time_ms([&] {  // Today: a root-to-node search for each side, then the shared prefix.
+        for (int i = 0; i < 20; i++) {
+            vector<Node<int> *> path_a, path_b;
+            find_pruned_path(tree.get_root(), pairs[i].first->get_value(), path_a, [](const Node<int> *) { return true; });
+            find_pruned_path(tree.get_root(), pairs[i].second->get_value(), path_b, [](const Node<int> *) { return true; });
+            size_t shared = 0;
+            while (shared < min(path_a.size(), path_b.size()) && path_a[shared] == path_b[shared]) shared++;
+            checksum += path_a[shared - 1]->get_value();
+        }
+    }) / 20;
+    double build = time_ms([&] { tree.get_lca_index(); });
+    double indexed = time_ms([&] {
+        for (const auto &query : pairs) checksum += tree.lca(query.first, query.second)->get_value();
+    });
+
+    cout << "lowest common ancestor (" << count << " nodes)" << endl;
+    cout << "  two root-to-node searches: " << paths * 1000 << " us per query" << endl;
+    cout << "  sparse table:              " << indexed * 1e6 / queries << " ns per query (checksum " << checksum << ")" << endl;
+    cout << "  table build:               " << build << " ms, " << tree.get_lca_index().table_bytes() / (1 << 20) << " MB" << endl;
+}
+
+void bench_parents(size_t count) {
+    Tree<int, 3> tree;
+    vector<Node<int> *> nodes = {tree.emplace_root(0)};
+    nodes.reserve(count);
+    for (size_t i = 1; i < count; i++) nodes.push_back(nodes[(i - 1) / 3]->emplace_child(static_cast<int>(i)));
+    mt19937_64 rng(3);
+    const int queries = 1000000;
+    vector<Node<int> *> targets(queries);
+    for (auto &target : targets) target = nodes[rng() % count];
+    size_t checksum = 0;  // Used in the output, so no walk can be optimized away.
+
+    double search = time_ms([&] {  // Without parent links: search from the root, keeping the path.
+        vector<Node<int> *> path;
+        for (int i = 0; i < 20; i++) {
+            find_pruned_path(tree.get_root(), targets[i]->get_value(), path, [](const Node<int> *) { return true; });
+            checksum += path.size();
+        }
+    }) / 20;
+    double links = time_ms([&] {
+        for (Node<int> *target : targets) {
+            for (Node<int> *node : path_from_root(target)) checksum += node->get_value() & 1;
+        }
+    });
+
+    cout << "parent links (" << count << " nodes, " << sizeof(Node<int>) << " bytes per Node<int>)" << endl;
+    cout << "  path by search from the root: " << search * 1000 << " us per node" << endl;
+    cout << "  path_from_root:               " << links * 1e6 / queries << " ns per node (checksum " << checksum << ")" << endl;
+}
+
+void bench_culling(size_t count) {
+    cout << "viewport culling (750x650 window)" << endl;
+    for (size_t n = count / 100; n <= count; n *= 10) {
+        Tree<int, 3> tree;
+        build_complete_tree(tree, n);
+        const TreeLayout<int> &layout = tree.get_layout(750);
+        LayoutGrid grid;
+        double build = time_ms([&] { grid.update(layout); });
+
+        float x0 = 0, x1 = 0, y1 = 0;  // Extent of the whole layout.
+        for (const LayoutPoint &p : layout.positions) {
+            x0 = min(x0, p.x);
+            x1 = max(x1, p.x);
+            y1 = max(y1, p.y);
+        }
+        float scale = 750 / max(x1 - x0, y1);  // Pixels per unit when the whole tree is in view.
+        size_t level = 0;
+        while (level + 1 < grid.level_count() && grid.cell_size(level) * scale < 6) level++;
+
+        const int frames = 100;
+        volatile size_t sink = 0;
+        size_t visible = 0, cells = 0;
+        double zoomed_in = time_ms([&] {  // Nodes under the default view.
+            for (int f = 0; f < frames; f++) grid.for_each_node(0, 0, 750, 650, [&](uint32_t i) { sink = sink + i; visible++; });
+        });
+        double zoomed_out = time_ms([&] {  // Aggregates when the whole tree is in view.
+            for (int f = 0; f < frames; f++) grid.for_each_cell(level, x0, 0, x1, y1, [&](const GridCell &c) { sink = sink + c.count; cells++; });
+        });
+        cout << "  " << n << " nodes: grid build " << build << " ms, default view " << zoomed_in * 1000 / frames << " us ("
+             << visible / frames << " nodes), whole tree " << zoomed_out * 1000 / frames << " us (" << cells / frames
+             << " aggregates)" << endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 2000000;
+    string only = argc > 2 ? argv[2] : "";  // Optional name of a single benchmark to run.
+    auto run = [&](const string &name, void (*bench)(size_t)) {
+        if (only.empty() || only == name) bench(count);
+    };
+
+    run("serialization", bench_serialization);
+    run("mapped", bench_mapped);
+    run("louds", bench_louds);
+    run("import", bench_edge_import);
+    run("layout", bench_layout);
+    run("culling", bench_culling);
+    run("export", bench_export);
+    run("complex_heap", bench_complex_heap);
+    run("find", bench_find);
+    run("summary", bench_summary);
+    run("bloom", bench_bloom);
+    run("shape", bench_shape);
+    run("intervals", bench_intervals);
+    run("lca", bench_lca);
+    run("parents", bench_parents);
+    return 0;
+}
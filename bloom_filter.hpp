@@ -0,0 +1,178 @@
+#ifndef BLOOM_FILTER_HPP
+#define BLOOM_FILTER_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "node.hpp"
+using namespace std;
+
+// True for types std::hash supports.
+template <typename T>
+struct is_hashable : is_default_constructible<hash<T>> {};
+
+/*
+ * Fixed-size Bloom filter over 64-bit hashes. The probes are derived from one hash by double hashing, so a
+ * lookup hashes the key once however many filters it is checked against.
+ */
+class BloomFilter {
+private:
+    vector<uint64_t> words;
+    uint64_t bits;
+    uint32_t probes;
+    size_t capacity;  // Values the filter was sized for.
+    size_t count = 0;  // Values inserted, duplicates included.
+
+    // Position of probe i among the filter's bits.
+    uint64_t position(uint64_t hash, uint32_t i) const {
+        uint32_t h1 = static_cast<uint32_t>(hash), h2 = static_cast<uint32_t>(hash >> 32) | 1;
+        return (static_cast<uint64_t>(h1 + i * h2) * bits) >> 32;  // Maps 32 bits onto [0, bits) without a division.
+    }
+
+public:
+    BloomFilter(size_t capacity, double bits_per_value) : capacity(capacity) {
+        bits = max<uint64_t>(64, static_cast<uint64_t>(ceil(capacity * bits_per_value)));
+        words.assign((bits + 63) / 64, 0);
+        probes = static_cast<uint32_t>(min(16.0, max(1.0, round(bits_per_value * log(2.0)))));  // Optimal k = m/n ln 2.
+    }
+
+    // Spreads the bits of a std::hash result (often the identity for integers) with the splitmix64 finalizer.
+    static uint64_t mix(uint64_t h) {
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        return h ^ (h >> 31);
+    }
+
+    void insert(uint64_t hash) {
+        for (uint32_t i = 0; i < probes; i++) {
+            uint64_t bit = position(hash, i);
+            words[bit >> 6] |= 1ULL << (bit & 63);
+        }
+        count++;
+    }
+
+    bool may_contain(uint64_t hash) const {
+        for (uint32_t i = 0; i < probes; i++) {
+            uint64_t bit = position(hash, i);
+            if ((words[bit >> 6] & (1ULL << (bit & 63))) == 0) return false;
+        }
+        return true;
+    }
+
+    bool is_overfull() const { return count > 2 * capacity; }  // The false positive rate has drifted well past its target.
+
+    size_t size() const { return count; }
+
+    size_t memory_bytes() const { return sizeof(*this) + words.size() * sizeof(uint64_t); }
+};
+
+/*
+ * Bloom filters of the values below every node whose subtree has at least min_subtree_size nodes, so a
+ * search can skip subtrees that definitely do not hold the key. Smaller subtrees and leaves carry no filter
+ * and are always entered. Kept current by the tree on add_sub_node and rebuilt after any other change.
+ */
+template <typename T>
+class SubtreeBloom {
+private:
+    unordered_map<const Node<T> *, BloomFilter> filters;
+    size_t min_subtree_size = 256;
+    double bits_per_value = 10;  // About 1% false positives with 7 probes.
+    uint64_t version = UINT64_MAX;  // Tree version the filters describe.
+    size_t built_size = 0;  // Tree size at the last rebuild.
+    size_t tree_size = 0;
+
+    // Filter holding every value below node, sized for count values.
+    BloomFilter build_filter(const Node<T> *node, size_t count) const {
+        BloomFilter filter(count, bits_per_value);
+        vector<const Node<T> *> stack = {node};
+        while (!stack.empty()) {
+            const Node<T> *curr = stack.back();
+            stack.pop_back();
+            filter.insert(hash_of(curr->get_value()));
+            for (const Node<T> *child : curr->get_children()) stack.push_back(child);
+        }
+        return filter;
+    }
+
+public:
+    static uint64_t hash_of(const T &value) { return BloomFilter::mix(hash<T>()(value)); }
+
+    void configure(size_t min_size, double bits) {
+        if (min_size < 2 || bits <= 0) throw invalid_argument("Bloom filters need a subtree size of at least 2 and positive bits per value.");
+        min_subtree_size = min_size;
+        bits_per_value = bits;
+        version = UINT64_MAX;  // Rebuild with the new sizes.
+    }
+
+    bool is_current(uint64_t tree_version) const { return version == tree_version; }
+
+    void clear() {
+        filters.clear();
+        version = UINT64_MAX;
+    }
+
+    void rebuild(Node<T> *root, uint64_t tree_version) {
+        filters.clear();
+        vector<Node<T> *> order;  // Pre-order: every subtree is a contiguous run starting at its root.
+        vector<size_t> parent;
+        vector<uint64_t> hashes;
+        vector<pair<Node<T> *, size_t>> stack;
+        if (root != nullptr) stack.push_back({root, SIZE_MAX});
+        while (!stack.empty()) {
+            auto [node, from] = stack.back();
+            stack.pop_back();
+            order.push_back(node);
+            parent.push_back(from);
+            hashes.push_back(hash_of(node->get_value()));
+            const auto &children = node->get_children();
+            for (size_t i = children.size(); i > 0; i--) stack.push_back({children[i - 1], order.size() - 1});
+        }
+        vector<size_t> sizes(order.size(), 1);
+        built_size = tree_size = order.size();
+        for (size_t i = order.size(); i > 1; i--) sizes[parent[i - 1]] += sizes[i - 1];  // Children follow their parent.
+        for (size_t i = 0; i < order.size(); i++) {
+            if (sizes[i] < min_subtree_size) continue;
+            BloomFilter filter(sizes[i], bits_per_value);
+            for (size_t j = i; j < i + sizes[i]; j++) filter.insert(hashes[j]);  // Hashed once, inserted per ancestor.
+            filters.emplace(order[i], std::move(filter));
+        }
+        version = tree_version;
+    }
+
+    // Records a new leaf under path.back(); path runs from the root to the parent. Subtrees that grew past
+    // min_subtree_size get their filters when the tree has doubled since the last rebuild.
+    void insert(const vector<Node<T> *> &path, const Node<T> *child, uint64_t tree_version) {
+        if (++tree_size >= 2 * built_size && tree_size >= min_subtree_size) {
+            rebuild(path.front(), tree_version);  // Doubling keeps the rebuilds at O(depth) per insert, amortized.
+            return;
+        }
+        uint64_t hash = hash_of(child->get_value());
+        for (Node<T> *node : path) {
+            auto found = filters.find(node);
+            if (found == filters.end()) continue;
+            found->second.insert(hash);
+            if (found->second.is_overfull()) found->second = build_filter(node, found->second.size());  // Resize.
+        }
+        version = tree_version;
+    }
+
+    bool may_contain(const Node<T> *node, uint64_t hash) const {
+        auto found = filters.find(node);
+        return found == filters.end() || found->second.may_contain(hash);
+    }
+
+    const unordered_map<const Node<T> *, BloomFilter> &get_filters() const { return filters; }
+
+    // Filter bits plus the hash map entries that own them.
+    size_t memory_bytes() const {
+        size_t bytes = filters.bucket_count() * sizeof(void *);
+        for (const auto &entry : filters) bytes += entry.second.memory_bytes() + sizeof(entry) + sizeof(void *);
+        return bytes;
+    }
+};
+
+#endif // BLOOM_FILTER_HPP
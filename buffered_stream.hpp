@@ -0,0 +1,145 @@
+#ifndef BUFFERED_STREAM_HPP
+#define BUFFERED_STREAM_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+using namespace std;
+
+const size_t STREAM_CHUNK_SIZE = 1 << 20;  // Bytes moved per stream read/write call.
+
+// count * size + extra, clamped at UINT64_MAX instead of wrapping around for sizes read from untrusted input.
+inline uint64_t saturating_bytes(uint64_t count, uint64_t size, uint64_t extra = 0) {
+    if (size != 0 && count > (UINT64_MAX - extra) / size) return UINT64_MAX;
+    return count * size + extra;
+}
+
+// Collects small writes into a large buffer and hands it to the stream in big chunks.
+class BufferedWriter {
+private:
+    ostream &os;  // Destination stream.
+    vector<char> buffer;  // Pending bytes not yet written to the stream.
+    size_t used;  // Number of pending bytes in the buffer.
+
+public:
+    explicit BufferedWriter(ostream &out, size_t chunk_size = STREAM_CHUNK_SIZE)
+        : os(out), buffer(chunk_size), used(0) {}
+
+    ~BufferedWriter() { flush(); }  // Never lose buffered bytes.
+
+    BufferedWriter(const BufferedWriter &) = delete;
+    BufferedWriter &operator=(const BufferedWriter &) = delete;
+
+    void write(const void *data, size_t size) {
+        if (size == 0) return;  // data may be null for empty views.
+        if (used + size > buffer.size()) {
+            flush();  // Make room for the new bytes.
+            if (size > buffer.size()) {
+                os.write(static_cast<const char *>(data), size);  // Too big to buffer, write it directly.
+                return;
+            }
+        }
+        memcpy(buffer.data() + used, data, size);
+        used += size;
+    }
+
+    template <typename U>
+    void write_pod(const U &value) {
+        write(&value, sizeof(U));  // Write the raw bytes of a trivially copyable value.
+    }
+
+    void write_text(string_view text) { write(text.data(), text.size()); }
+
+    // Writes a number as text through to_chars; floating point values get the given number of decimals.
+    template <typename U>
+    void write_number(U value, int decimals = 1) {
+        char digits[400];  // Room for any double in fixed notation.
+        to_chars_result result;
+        if constexpr (is_floating_point<U>::value) {
+            result = to_chars(digits, digits + sizeof(digits), value, chars_format::fixed, decimals);
+        } else {
+            result = to_chars(digits, digits + sizeof(digits), value);
+        }
+        write(digits, static_cast<size_t>(result.ptr - digits));
+    }
+
+    void flush() {
+        if (used > 0) {
+            os.write(buffer.data(), used);
+            used = 0;
+        }
+    }
+};
+
+// Pulls bytes from a stream in large chunks and serves small reads from memory. It never reads past the
+// bytes announced through expect(), so whatever follows the record in the stream is left for the next reader.
+class BufferedReader {
+private:
+    istream &is;  // Source stream.
+    vector<char> buffer;  // Bytes read from the stream but not yet consumed.
+    size_t pos;  // Position of the next unread byte in the buffer.
+    size_t filled;  // Number of valid bytes in the buffer.
+    uint64_t ahead;  // Announced bytes not yet fetched from the stream; refills may read this far.
+
+    bool refill(size_t wanted) {
+        size_t size = static_cast<size_t>(min<uint64_t>(buffer.size(), max<uint64_t>(ahead, wanted)));
+        is.read(buffer.data(), size);
+        filled = static_cast<size_t>(is.gcount());
+        pos = 0;
+        ahead -= min<uint64_t>(ahead, filled);
+        return filled > 0;
+    }
+
+public:
+    explicit BufferedReader(istream &in, size_t chunk_size = STREAM_CHUNK_SIZE)
+        : is(in), buffer(chunk_size), pos(0), filled(0), ahead(0) {}
+
+    // Announces that at least the given number of bytes will be read next, so they can be fetched in chunks.
+    void expect(uint64_t bytes) {
+        uint64_t buffered = filled - pos;
+        if (bytes > buffered) ahead = max(ahead, bytes - buffered);
+    }
+
+    void read(void *data, size_t size) {
+        char *out = static_cast<char *>(data);
+        while (size > 0) {
+            if (pos == filled && !refill(size)) {
+                throw runtime_error("Unexpected end of stream.");  // The stream ended in the middle of a value.
+            }
+            size_t take = min(size, filled - pos);
+            memcpy(out, buffer.data() + pos, take);
+            pos += take;
+            out += take;
+            size -= take;
+        }
+    }
+
+    // Reads size bytes into text, growing it one chunk at a time, so a corrupt size runs into the end of the
+    // stream instead of allocating the whole claimed length up front.
+    void read_text(string &text, uint64_t size) {
+        text.clear();
+        while (text.size() < size) {
+            size_t take = static_cast<size_t>(min<uint64_t>(size - text.size(), buffer.size()));
+            size_t old_size = text.size();
+            text.resize(old_size + take);
+            read(&text[old_size], take);
+        }
+    }
+
+    template <typename U>
+    U read_pod() {
+        U value;
+        read(&value, sizeof(U));  // Read the raw bytes of a trivially copyable value.
+        return value;
+    }
+};
+
+#endif // BUFFERED_STREAM_HPP
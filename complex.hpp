@@ -7,15 +7,17 @@ class Complex {
 private:
     double real;
     double imag;
+    double magnitude_squared;  // Cached comparison key; the value never changes after construction.
 
 public:
-    Complex(double r, double i) : real(r), imag(i) {}
+    Complex(double r, double i) : real(r), imag(i), magnitude_squared(r * r + i * i) {}
 
     double get_real() const {return real;}
     double get_imag() const {return imag;}
     double Magnitude() const{
-        return sqrt(pow(real,2) + pow(imag,2));
+        return sqrt(magnitude_squared);
     }
+    double MagnitudeSquared() const {return magnitude_squared;}  // Orders values like Magnitude(), without sqrt.
     bool operator==(const Complex &other) const {
         return real == other.real && imag == other.imag;
     }
@@ -25,11 +27,11 @@ public:
     }
 
     bool operator<(const Complex& other) const {
-        return Magnitude() < other.Magnitude();
+        return magnitude_squared < other.magnitude_squared;  // sqrt is monotonic, so squared magnitudes order the same.
     }
 
     bool operator>(const Complex& other) const {
-        return !(*this < other);
+        return other < *this;  // Strict, like operator<: equal magnitudes are neither.
     }
 
     friend ostream& operator<<(ostream& os, const Complex& c){
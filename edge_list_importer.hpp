@@ -0,0 +1,141 @@
+#ifndef EDGE_LIST_IMPORTER_HPP
+#define EDGE_LIST_IMPORTER_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "tree_builder.hpp"
+using namespace std;
+
+const size_t IMPORT_BLOCK_SIZE = 64 << 20;  // Bytes of text read from disk per block.
+
+// Parses one token into a value; numbers go through from_chars, strings are taken verbatim.
+template <typename T>
+bool parse_edge_token(const char *first, const char *last, T &value) {
+    if constexpr (is_same<T, string>::value) {
+        value.assign(first, last);
+        return first != last;
+    } else {
+        static_assert(is_arithmetic<T>::value, "Edge lists hold numbers or strings");
+        auto result = from_chars(first, last, value);
+        return result.ec == errc() && result.ptr == last;
+    }
+}
+
+// Parses the complete lines in [first, last) as "parent,child" or "parent child" edges.
+template <typename T>
+void parse_edge_lines(const char *first, const char *last, vector<pair<T, T>> &edges) {
+    auto is_blank = [](char c) { return c == ' ' || c == '\t' || c == '\r'; };
+    while (first < last) {
+        const char *line_end = find(first, last, '\n');
+        const char *p = first;
+        while (p < line_end && is_blank(*p)) p++;  // Skip leading blanks.
+        const char *end = line_end;
+        while (end > p && is_blank(end[-1])) end--;  // Skip trailing blanks and '\r'.
+
+        if (p < end) {
+            const char *parent_end = p;
+            while (parent_end < end && *parent_end != ',' && !is_blank(*parent_end)) parent_end++;
+            const char *child = parent_end;
+            while (child < end && is_blank(*child)) child++;
+            if (child < end && *child == ',') child++;
+            while (child < end && is_blank(*child)) child++;
+
+            pair<T, T> edge;
+            if (!parse_edge_token(p, parent_end, edge.first) || !parse_edge_token(child, end, edge.second)) {
+                throw runtime_error("Malformed edge: '" + string(first, line_end) + "'");
+            }
+            edges.push_back(std::move(edge));
+        }
+        first = line_end + 1;
+    }
+}
+
+/*
+ * Streams a "parent,child" / "parent child" edge-list file into a tree.
+ *
+ * The file is read in large blocks cut at the last newline; each block is split at line boundaries into
+ * one slice per thread, the slices are parsed in parallel, and the edges are handed to a TreeBuilder in
+ * file order. Only one block of text is held in memory at a time. For an empty tree, the one parent that
+ * never appears as a child becomes the root; input with no such parent, or several, is rejected.
+ */
+template <typename T, int K>
+void import_edge_list(const string &path, Tree<T, K> &tree, unsigned threads = thread::hardware_concurrency(),
+                      size_t block_size = IMPORT_BLOCK_SIZE) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == nullptr) throw runtime_error("Cannot open edge list '" + path + "'.");
+
+    threads = max(1u, threads);
+    TreeBuilder<T, K> builder(tree);
+    vector<char> block;
+    vector<vector<pair<T, T>>> parsed(threads);  // One output list per slice, reused across blocks.
+    size_t carried = 0;  // Bytes of an unfinished line kept from the previous block.
+    bool at_end = false;
+
+    try {
+        while (!at_end) {
+            block.resize(carried + block_size);
+            size_t got = fread(block.data() + carried, 1, block_size, file);
+            at_end = got < block_size;
+            size_t filled = carried + got;
+
+            size_t usable = filled;  // Parse up to and including the last newline.
+            if (!at_end) {
+                while (usable > 0 && block[usable - 1] != '\n') usable--;
+                if (usable == 0) {  // A single line longer than the block: keep reading.
+                    carried = filled;
+                    continue;
+                }
+            }
+
+            // Cut the usable bytes into slices that end on line boundaries.
+            vector<size_t> cuts = {0};
+            for (unsigned t = 1; t < threads; t++) {
+                size_t cut = max(cuts.back(), usable * t / threads);
+                while (cut < usable && cut > 0 && block[cut - 1] != '\n') cut++;
+                cuts.push_back(cut);
+            }
+            cuts.push_back(usable);
+
+            vector<thread> workers;
+            vector<exception_ptr> errors(threads);
+            for (unsigned t = 0; t < threads; t++) {
+                parsed[t].clear();
+                auto work = [&, t] {
+                    try {
+                        parse_edge_lines(block.data() + cuts[t], block.data() + cuts[t + 1], parsed[t]);
+                    } catch (...) {
+                        errors[t] = current_exception();
+                    }
+                };
+                if (t + 1 == threads) work();  // The calling thread parses the last slice itself.
+                else workers.emplace_back(work);
+            }
+            for (auto &worker : workers) worker.join();
+            for (auto &error : errors) {
+                if (error) rethrow_exception(error);
+            }
+
+            for (auto &edges : parsed) {
+                for (auto &edge : edges) builder.add_edge(edge.first, std::move(edge.second));
+            }
+
+            carried = filled - usable;  // Move the unfinished line to the front.
+            copy(block.begin() + usable, block.begin() + filled, block.begin());
+        }
+    } catch (...) {
+        fclose(file);
+        throw;
+    }
+    fclose(file);
+    builder.finish();
+}
+
+#endif // EDGE_LIST_IMPORTER_HPP
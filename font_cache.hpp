@@ -0,0 +1,40 @@
+#ifndef FONT_CACHE_HPP
+#define FONT_CACHE_HPP
+
+#include <iostream>
+#include <mutex>
+#include <SFML/Graphics.hpp>
+#ifdef EX2_EMBEDDED_FONT
+#include "embedded_font.hpp"  // Generated from arial.ttf by the build: cmake -DEX2_EMBED_FONT=ON or make EMBED_FONT=1.
+#endif
+using namespace std;
+
+const char *const FONT_PATH = "arial.ttf";  // Label font, looked up in the working directory.
+
+// The label font shared by every window in the process.
+struct SharedFont {
+    sf::Font font;
+    bool loaded = false;  // False if neither the embedded bytes nor FONT_PATH could be loaded.
+    mutex lock;  // sf::Font fills its glyph atlas lazily: hold this while building or drawing text with it.
+};
+
+/*
+ * Returns the process-wide font, parsing it on the first call only.
+ *
+ * Builds with EX2_EMBEDDED_FONT load the font from bytes compiled into the binary, so no file is read and the
+ * working directory does not matter. Otherwise, or if the embedded data cannot be parsed, FONT_PATH is loaded.
+ */
+inline SharedFont &shared_font() {
+    static SharedFont shared;
+    static once_flag once;
+    call_once(once, [] {
+#ifdef EX2_EMBEDDED_FONT
+        shared.loaded = shared.font.loadFromMemory(EMBEDDED_FONT, sizeof(EMBEDDED_FONT));
+#endif
+        if (!shared.loaded) shared.loaded = shared.font.loadFromFile(FONT_PATH);
+        if (!shared.loaded) cerr << "Failed to load font file '" << FONT_PATH << "'" << endl;  // Reported once.
+    });
+    return shared;
+}
+
+#endif // FONT_CACHE_HPP
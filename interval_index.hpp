@@ -0,0 +1,98 @@
+#ifndef INTERVAL_INDEX_HPP
+#define INTERVAL_INDEX_HPP
+
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include "node.hpp"
+using namespace std;
+
+// Contiguous run of nodes in a flat array, usable in a range-for.
+template <typename T>
+struct NodeSpan {
+    Node<T> *const *first;
+    Node<T> *const *last;
+
+    Node<T> *const *begin() const { return first; }
+    Node<T> *const *end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+};
+
+// Pre-order entry and exit numbers of a node: its subtree holds positions [entry, exit).
+struct NodeInterval {
+    uint32_t entry;
+    uint32_t exit;
+};
+
+/*
+ * Flat pre-order copy of a tree with the interval of every node. Since a subtree is the contiguous run
+ * [entry, exit), ancestor checks and descendant counts are O(1) and a subtree is a slice of the array.
+ * Built in one pass; the tree rebuilds it after changes.
+ */
+template <typename T>
+class PreOrderIndex {
+private:
+    vector<Node<T> *> order;  // Nodes in pre-order.
+    vector<uint32_t> exits;  // One past the last position of each node's subtree.
+    unordered_map<const Node<T> *, uint32_t> positions;  // Entry number of every node.
+    uint64_t version = UINT64_MAX;  // Tree version the index describes.
+
+public:
+    bool is_current(uint64_t tree_version) const { return version == tree_version; }
+
+    void rebuild(Node<T> *root, uint64_t tree_version) {
+        order.clear();
+        exits.clear();
+        positions.clear();
+        vector<pair<Node<T> *, size_t>> stack;  // (node, next child), the path to the current node.
+        if (root != nullptr) stack.push_back({root, 0});
+        while (!stack.empty()) {
+            Node<T> *node = stack.back().first;
+            if (stack.back().second == 0) {  // First visit: the entry number.
+                positions.emplace(node, static_cast<uint32_t>(order.size()));
+                order.push_back(node);
+                exits.push_back(0);
+            }
+            const auto &children = node->get_children();
+            if (stack.back().second < children.size()) {
+                stack.push_back({children[stack.back().second++], 0});
+                continue;
+            }
+            exits[positions.at(node)] = static_cast<uint32_t>(order.size());  // Last visit: the exit number.
+            stack.pop_back();
+        }
+        version = tree_version;
+    }
+
+    size_t size() const { return order.size(); }
+
+    // Entry and exit numbers of node; throws out_of_range if node is not in the tree.
+    NodeInterval interval(const Node<T> *node) const {
+        uint32_t entry = positions.at(node);
+        return NodeInterval{entry, exits[entry]};
+    }
+
+    // True if node lies in ancestor's subtree, ancestor itself included.
+    bool is_ancestor(const Node<T> *ancestor, const Node<T> *node) const {
+        NodeInterval outer = interval(ancestor);
+        uint32_t entry = positions.at(node);
+        return outer.entry <= entry && entry < outer.exit;
+    }
+
+    // Nodes strictly below node.
+    size_t descendant_count(const Node<T> *node) const {
+        NodeInterval range = interval(node);
+        return range.exit - range.entry - 1;
+    }
+
+    // node and everything below it, in pre-order.
+    NodeSpan<T> subtree(const Node<T> *node) const {
+        NodeInterval range = interval(node);
+        return NodeSpan<T>{order.data() + range.entry, order.data() + range.exit};
+    }
+
+    Node<T> *at(size_t position) const { return order.at(position); }
+};
+
+#endif // INTERVAL_INDEX_HPP
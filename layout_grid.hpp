@@ -0,0 +1,160 @@
+#ifndef LAYOUT_GRID_HPP
+#define LAYOUT_GRID_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "tree_layout.hpp"
+using namespace std;
+
+const float GRID_CELL_SIZE = NODE_RADIUS * 8;  // Side of a finest-level grid cell, in layout units.
+
+// One occupied grid cell: a range of the sorted node list plus the box around those nodes' centers.
+struct GridCell {
+    uint32_t start;  // First entry in the node order (finest level only).
+    uint32_t count;  // Nodes inside the cell.
+    float min_x, min_y, max_x, max_y;
+};
+
+/*
+ * Sparse uniform grid over a layout, used to find what lies inside the visible rectangle.
+ *
+ * Level 0 lists the nodes and edges of every occupied cell. Each higher level doubles the cell size and
+ * only keeps counts and bounding boxes, so a zoomed-out view can draw one aggregate per cell instead of
+ * every node underneath it.
+ */
+class LayoutGrid {
+private:
+    vector<unordered_map<uint64_t, GridCell>> levels;  // Occupied cells per level, keyed by packed coordinates.
+    vector<uint32_t> node_order;  // Node indices sorted by level-0 cell.
+    unordered_map<uint64_t, vector<uint32_t>> edge_cells;  // Level-0 cell -> edges (by child index) crossing it.
+    uint64_t version = UINT64_MAX;  // Layout version the grid was built from.
+    float width = -1;  // Layout width the grid was built from.
+    float origin_x = 0, origin_y = 0;  // Corner of the layout, so cell coordinates are never negative.
+
+    static uint64_t key(int64_t cx, int64_t cy) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+    }
+
+    static int64_t cell_of(float coord, float size) { return static_cast<int64_t>(floor(coord / size)); }
+
+    int64_t cell_x(float x, float size) const { return cell_of(x - origin_x, size); }
+    int64_t cell_y(float y, float size) const { return cell_of(y - origin_y, size); }
+
+public:
+    // Rebuilds the grid if the layout changed since the last call.
+    template <typename T>
+    void update(const TreeLayout<T> &layout) {
+        if (layout.version == version && layout.width == width) return;
+        version = layout.version;
+        width = layout.width;
+        levels.clear();
+        edge_cells.clear();
+        origin_x = origin_y = 0;
+        for (size_t i = 0; i < layout.size(); i++) {
+            origin_x = i == 0 ? layout.positions[i].x : min(origin_x, layout.positions[i].x);
+            origin_y = i == 0 ? layout.positions[i].y : min(origin_y, layout.positions[i].y);
+        }
+
+        // Level 0: bucket nodes by cell, then lay the buckets out contiguously.
+        vector<pair<uint64_t, uint32_t>> keyed(layout.size());
+        for (uint32_t i = 0; i < layout.size(); i++) {
+            keyed[i] = {key(cell_x(layout.positions[i].x, GRID_CELL_SIZE), cell_y(layout.positions[i].y, GRID_CELL_SIZE)), i};
+        }
+        sort(keyed.begin(), keyed.end());
+        node_order.resize(keyed.size());
+        levels.emplace_back();
+        for (uint32_t i = 0; i < keyed.size(); i++) {
+            node_order[i] = keyed[i].second;
+            const LayoutPoint &p = layout.positions[keyed[i].second];
+            auto inserted = levels[0].emplace(keyed[i].first, GridCell{i, 0, p.x, p.y, p.x, p.y});
+            GridCell &cell = inserted.first->second;
+            cell.count++;
+            cell.min_x = min(cell.min_x, p.x);
+            cell.min_y = min(cell.min_y, p.y);
+            cell.max_x = max(cell.max_x, p.x);
+            cell.max_y = max(cell.max_y, p.y);
+        }
+
+        // Edges go into every cell their bounding box touches, so long edges are found from any of them.
+        for (uint32_t i = 0; i < layout.size(); i++) {
+            if (layout.parents[i] == NO_PARENT) continue;
+            const LayoutPoint &a = layout.positions[i], &b = layout.positions[layout.parents[i]];
+            for (int64_t cx = cell_x(min(a.x, b.x), GRID_CELL_SIZE); cx <= cell_x(max(a.x, b.x), GRID_CELL_SIZE); cx++) {
+                for (int64_t cy = cell_y(min(a.y, b.y), GRID_CELL_SIZE); cy <= cell_y(max(a.y, b.y), GRID_CELL_SIZE); cy++) {
+                    edge_cells[key(cx, cy)].push_back(i);
+                }
+            }
+        }
+
+        // Coarser levels merge 2x2 cells until a single cell is left.
+        while (levels.back().size() > 1) {
+            unordered_map<uint64_t, GridCell> coarser;
+            for (const auto &entry : levels.back()) {
+                uint64_t cx = entry.first >> 32, cy = entry.first & 0xffffffffu;
+                const GridCell &fine = entry.second;
+                auto inserted = coarser.emplace(key(static_cast<int64_t>(cx >> 1), static_cast<int64_t>(cy >> 1)), GridCell{0, 0, fine.min_x, fine.min_y, fine.max_x, fine.max_y});
+                GridCell &cell = inserted.first->second;
+                cell.count += fine.count;
+                cell.min_x = min(cell.min_x, fine.min_x);
+                cell.min_y = min(cell.min_y, fine.min_y);
+                cell.max_x = max(cell.max_x, fine.max_x);
+                cell.max_y = max(cell.max_y, fine.max_y);
+            }
+            levels.push_back(std::move(coarser));
+        }
+    }
+
+    size_t level_count() const { return levels.size(); }
+
+    float cell_size(size_t level) const { return GRID_CELL_SIZE * static_cast<float>(uint64_t(1) << level); }
+
+    // Calls f(cell) for every occupied cell of the level that overlaps the rectangle.
+    template <typename F>
+    void for_each_cell(size_t level, float x0, float y0, float x1, float y1, F f) const {
+        if (level >= levels.size()) return;
+        float size = cell_size(level);
+        int64_t cx0 = max<int64_t>(0, cell_x(x0, size)), cx1 = cell_x(x1, size);
+        int64_t cy0 = max<int64_t>(0, cell_y(y0, size)), cy1 = cell_y(y1, size);
+        if (cx1 < cx0 || cy1 < cy0) return;
+        if (static_cast<uint64_t>((cx1 - cx0 + 1) * (cy1 - cy0 + 1)) > levels[level].size()) {
+            for (const auto &entry : levels[level]) {  // Fewer occupied cells than cells in view: scan them all.
+                const GridCell &cell = entry.second;
+                if (cell.max_x >= x0 - size && cell.min_x <= x1 + size && cell.max_y >= y0 - size && cell.min_y <= y1 + size) f(cell);
+            }
+            return;
+        }
+        for (int64_t cx = cx0; cx <= cx1; cx++) {
+            for (int64_t cy = cy0; cy <= cy1; cy++) {
+                auto found = levels[level].find(key(cx, cy));
+                if (found != levels[level].end()) f(found->second);
+            }
+        }
+    }
+
+    // Calls f(node_index) for every node whose cell overlaps the rectangle.
+    template <typename F>
+    void for_each_node(float x0, float y0, float x1, float y1, F f) const {
+        for_each_cell(0, x0, y0, x1, y1, [&](const GridCell &cell) {
+            for (uint32_t i = cell.start; i < cell.start + cell.count; i++) f(node_order[i]);
+        });
+    }
+
+    // Calls f(child_index) for every edge listed in a cell overlapping the rectangle; edges may repeat.
+    template <typename F>
+    void for_each_edge(float x0, float y0, float x1, float y1, F f) const {
+        int64_t cx0 = max<int64_t>(0, cell_x(x0, GRID_CELL_SIZE)), cx1 = cell_x(x1, GRID_CELL_SIZE);
+        int64_t cy0 = max<int64_t>(0, cell_y(y0, GRID_CELL_SIZE)), cy1 = cell_y(y1, GRID_CELL_SIZE);
+        for (int64_t cx = cx0; cx <= cx1; cx++) {
+            for (int64_t cy = cy0; cy <= cy1; cy++) {
+                auto found = edge_cells.find(key(cx, cy));
+                if (found == edge_cells.end()) continue;
+                for (uint32_t child : found->second) f(child);
+            }
+        }
+    }
+};
+
+#endif // LAYOUT_GRID_HPP
@@ -0,0 +1,90 @@
+#ifndef LCA_INDEX_HPP
+#define LCA_INDEX_HPP
+
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include "node.hpp"
+using namespace std;
+
+/*
+ * Lowest common ancestor queries in O(1) after O(n log n) preprocessing. This is the Euler tour + RMQ
+ * method on the pre-order sequence (n entries instead of the 2n - 1 of the full tour): for nodes at
+ * positions l < r, the shallowest node in (l, r] is a child of their LCA, and a sparse table finds it
+ * with two lookups.
+ */
+template <typename T>
+class LcaIndex {
+private:
+    vector<Node<T> *> order;  // Nodes in pre-order.
+    vector<uint32_t> depths;  // Depth of each position.
+    vector<uint32_t> parents;  // Position of each position's parent; the root points at itself.
+    vector<vector<uint32_t>> table;  // table[j][i]: shallowest position in [i, i + 2^j).
+    unordered_map<const Node<T> *, uint32_t> positions;
+    uint64_t version = UINT64_MAX;  // Tree version the index describes.
+
+    static uint32_t floor_log2(uint32_t x) { return 31 - static_cast<uint32_t>(__builtin_clz(x)); }
+
+    uint32_t shallower(uint32_t a, uint32_t b) const { return depths[b] < depths[a] ? b : a; }
+
+public:
+    bool is_current(uint64_t tree_version) const { return version == tree_version; }
+
+    void rebuild(Node<T> *root, uint64_t tree_version) {
+        order.clear();
+        depths.clear();
+        parents.clear();
+        positions.clear();
+        vector<pair<Node<T> *, uint32_t>> stack;  // (node, parent position)
+        if (root != nullptr) stack.push_back({root, 0});
+        while (!stack.empty()) {
+            auto [node, parent] = stack.back();
+            stack.pop_back();
+            uint32_t position = static_cast<uint32_t>(order.size());
+            positions.emplace(node, position);
+            order.push_back(node);
+            parents.push_back(parent);
+            depths.push_back(position == 0 ? 0 : depths[parent] + 1);
+            const auto &children = node->get_children();
+            for (size_t i = children.size(); i > 0; i--) stack.push_back({children[i - 1], position});
+        }
+
+        uint32_t n = static_cast<uint32_t>(order.size());
+        table.assign(n == 0 ? 0 : floor_log2(n) + 1, {});
+        if (n == 0) {
+            version = tree_version;
+            return;
+        }
+        table[0].resize(n);
+        for (uint32_t i = 0; i < n; i++) table[0][i] = i;
+        for (uint32_t j = 1; j < table.size(); j++) {
+            uint32_t half = 1u << (j - 1);
+            table[j].resize(n - (1u << j) + 1);
+            for (uint32_t i = 0; i < table[j].size(); i++) table[j][i] = shallower(table[j - 1][i], table[j - 1][i + half]);
+        }
+        version = tree_version;
+    }
+
+    // Deepest node that has both a and b in its subtree; a node is its own ancestor. Throws out_of_range if
+    // either node is not in the tree.
+    Node<T> *lca(const Node<T> *a, const Node<T> *b) const {
+        uint32_t l = positions.at(a), r = positions.at(b);
+        if (l == r) return order[l];
+        if (r < l) swap(l, r);
+        uint32_t level = floor_log2(r - l);  // Range (l, r] holds r - l positions.
+        uint32_t shallowest = shallower(table[level][l + 1], table[level][r - (1u << level) + 1]);
+        return order[parents[shallowest]];
+    }
+
+    size_t size() const { return order.size(); }
+
+    // Bytes held by the arrays and the sparse table, excluding the node lookup map.
+    size_t table_bytes() const {
+        size_t bytes = order.size() * (sizeof(Node<T> *) + 2 * sizeof(uint32_t));
+        for (const auto &level : table) bytes += level.size() * sizeof(uint32_t);
+        return bytes;
+    }
+};
+
+#endif // LCA_INDEX_HPP
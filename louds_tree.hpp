@@ -0,0 +1,291 @@
+#ifndef LOUDS_TREE_HPP
+#define LOUDS_TREE_HPP
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+#include "tree.hpp"
+using namespace std;
+
+// Static bit sequence with rank and select support (512-bit blocks, one sample per 512 set/unset bits).
+class RankSelectBits {
+private:
+    static constexpr size_t WORDS_PER_BLOCK = 8;  // 512 bits per rank block.
+    static constexpr size_t BITS_PER_BLOCK = 64 * WORDS_PER_BLOCK;
+    static constexpr size_t SAMPLE_RATE = 512;  // One select sample every 512 matching bits.
+
+    vector<uint64_t> words;  // The bits, least significant bit first.
+    size_t bit_count;
+    vector<uint64_t> block_ones;  // Number of ones before each block, plus a final total.
+    vector<uint32_t> one_samples;  // Block holding every SAMPLE_RATE-th one.
+    vector<uint32_t> zero_samples;  // Block holding every SAMPLE_RATE-th zero.
+
+    size_t block_zeros(size_t block) const { return block * BITS_PER_BLOCK - block_ones[block]; }
+
+    static size_t select_in_word(uint64_t word, size_t k) {
+        for (size_t i = 0; i < k; i++) word &= word - 1;  // Drop the k lowest set bits.
+        return static_cast<size_t>(__builtin_ctzll(word));
+    }
+
+public:
+    RankSelectBits() : bit_count(0) {}
+
+    void push_back(bool bit) {
+        if (bit_count % 64 == 0) words.push_back(0);
+        if (bit) words.back() |= uint64_t(1) << (bit_count % 64);
+        bit_count++;
+    }
+
+    // Builds the rank and select directories; call once after the last push_back.
+    void build() {
+        while (words.size() % WORDS_PER_BLOCK != 0) words.push_back(0);  // Pad to whole blocks.
+        size_t blocks = words.size() / WORDS_PER_BLOCK;
+        block_ones.assign(blocks + 1, 0);
+        one_samples.clear();
+        zero_samples.clear();
+
+        uint64_t ones = 0;
+        for (size_t b = 0; b < blocks; b++) {
+            block_ones[b] = ones;
+            uint64_t zeros = b * BITS_PER_BLOCK - ones;
+            uint64_t block_total = 0;
+            for (size_t w = 0; w < WORDS_PER_BLOCK; w++) block_total += __builtin_popcountll(words[b * WORDS_PER_BLOCK + w]);
+            uint64_t block_bits = min(BITS_PER_BLOCK, bit_count > b * BITS_PER_BLOCK ? bit_count - b * BITS_PER_BLOCK : 0);
+            while (one_samples.size() * SAMPLE_RATE < ones + block_total) one_samples.push_back(static_cast<uint32_t>(b));
+            while (zero_samples.size() * SAMPLE_RATE < zeros + (block_bits - block_total)) zero_samples.push_back(static_cast<uint32_t>(b));
+            ones += block_total;
+        }
+        block_ones[blocks] = ones;
+    }
+
+    size_t size() const { return bit_count; }
+
+    bool operator[](size_t i) const { return (words[i / 64] >> (i % 64)) & 1; }
+
+    // Number of ones in positions [0, i).
+    size_t rank1(size_t i) const {
+        size_t block = i / BITS_PER_BLOCK;
+        size_t rank = block_ones[block];
+        for (size_t w = block * WORDS_PER_BLOCK; w < i / 64; w++) rank += __builtin_popcountll(words[w]);
+        if (i % 64 != 0) rank += __builtin_popcountll(words[i / 64] & ((uint64_t(1) << (i % 64)) - 1));
+        return rank;
+    }
+
+    size_t rank0(size_t i) const { return i - rank1(i); }  // Number of zeros in positions [0, i).
+
+    // Position of the k-th one (0-based).
+    size_t select1(size_t k) const {
+        size_t block = one_samples[k / SAMPLE_RATE];
+        while (block_ones[block + 1] <= k) block++;
+        size_t remaining = k - block_ones[block];
+        for (size_t w = block * WORDS_PER_BLOCK;; w++) {
+            size_t count = __builtin_popcountll(words[w]);
+            if (remaining < count) return w * 64 + select_in_word(words[w], remaining);
+            remaining -= count;
+        }
+    }
+
+    // Position of the k-th zero (0-based).
+    size_t select0(size_t k) const {
+        size_t block = zero_samples[k / SAMPLE_RATE];
+        while (block_zeros(block + 1) <= k) block++;
+        size_t remaining = k - block_zeros(block);
+        for (size_t w = block * WORDS_PER_BLOCK;; w++) {
+            size_t count = __builtin_popcountll(~words[w]);
+            if (remaining < count) return w * 64 + select_in_word(~words[w], remaining);
+            remaining -= count;
+        }
+    }
+
+    size_t memory_bytes() const {
+        return words.size() * sizeof(uint64_t) + block_ones.size() * sizeof(uint64_t) +
+               (one_samples.size() + zero_samples.size()) * sizeof(uint32_t);
+    }
+};
+
+/*
+ * Static tree stored as a LOUDS bit sequence (about 2n bits) plus a dense value array.
+ *
+ * Nodes are numbered in BFS order. The bits are "10" for a virtual super root followed by, for each node,
+ * one 1 per child and a terminating 0. The i-th one stands for node i and the i-th zero opens the child
+ * list of node i - 1, so parent, first child and next sibling are each one rank or select away.
+ */
+template <typename T, int K = 2>
+class LoudsTree {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;  // Returned when a navigation step has no target.
+
+    // Lightweight handle to one node of the encoding.
+    class LoudsNode {
+    private:
+        const LoudsTree *tree;
+        uint32_t index;
+
+    public:
+        LoudsNode(const LoudsTree *t, uint32_t i) : tree(t), index(i) {}
+
+        uint32_t get_index() const { return index; }  // Position of the node in BFS order.
+
+        const T &get_value() const { return tree->values[index]; }
+
+        size_t child_count() const { return tree->degree(index); }
+
+        bool operator==(const LoudsNode &other) const { return tree == other.tree && index == other.index; }
+        bool operator!=(const LoudsNode &other) const { return !(*this == other); }
+    };
+
+    class iterator {
+    private:
+        const LoudsTree *owner;  // Tree being traversed.
+        const uint32_t *order;  // Visiting order, or nullptr to walk the BFS numbering directly.
+        size_t pos;  // Position within the traversal.
+        LoudsNode current;  // Handle for the node at pos, refreshed on access.
+
+        const LoudsNode &sync() {
+            current = LoudsNode(owner, order == nullptr ? static_cast<uint32_t>(pos) : order[pos]);
+            return current;
+        }
+
+    public:
+        iterator(const LoudsTree *t, const uint32_t *ord, size_t p) : owner(t), order(ord), pos(p), current(t, 0) {}
+
+        iterator &operator++() {
+            ++pos;  // Advance to the next node in the traversal.
+            return *this;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return pos != other.pos;  // Compare two iterators for inequality.
+        }
+
+        const LoudsNode &operator*() { return sync(); }  // Dereference the iterator to access the node.
+
+        const LoudsNode *operator->() { return &sync(); }  // Access the node handle.
+    };
+
+private:
+    RankSelectBits bits;  // LOUDS shape.
+    vector<T> values;  // Node values in BFS order.
+    vector<uint32_t> dfs_order;  // Scratch order for DFS traversals.
+
+public:
+    explicit LoudsTree(const Tree<T, K> &tree) {
+        vector<const Node<T> *> order;  // BFS order of the source tree.
+        if (tree.get_root() != nullptr) order.push_back(tree.get_root());
+        for (size_t i = 0; i < order.size(); i++) {
+            for (auto child : order[i]->get_children()) order.push_back(child);
+        }
+        if (order.size() >= NONE) throw runtime_error("Tree is too large for the LOUDS encoding.");
+
+        bits.push_back(true);  // Super root pointing at the real root.
+        bits.push_back(false);
+        values.reserve(order.size());
+        for (const Node<T> *node : order) {
+            for (size_t c = 0; c < node->get_children().size(); c++) bits.push_back(true);
+            bits.push_back(false);
+            values.push_back(node->get_value());
+        }
+        bits.build();
+    }
+
+    size_t size() const { return values.size(); }  // Number of nodes.
+
+    LoudsNode get_root() const {
+        if (values.empty()) throw runtime_error("Root node not found");
+        return LoudsNode(this, 0);
+    }
+
+    LoudsNode node_at(uint32_t index) const { return LoudsNode(this, index); }  // Handle for a BFS index.
+
+    size_t degree(uint32_t node) const { return bits.select0(node + 1) - bits.select0(node) - 1; }
+
+    uint32_t parent(uint32_t node) const {
+        if (node == 0) return NONE;
+        return static_cast<uint32_t>(bits.rank0(bits.select1(node)) - 1);
+    }
+
+    uint32_t first_child(uint32_t node) const {
+        size_t start = bits.select0(node) + 1;  // First bit of the node's child list.
+        return bits[start] ? static_cast<uint32_t>(bits.rank1(start)) : NONE;
+    }
+
+    uint32_t next_sibling(uint32_t node) const {
+        size_t pos = bits.select1(node) + 1;
+        return pos < bits.size() && bits[pos] ? node + 1 : NONE;  // Siblings are adjacent ones.
+    }
+
+    // Counts the subtree by walking its BFS levels, each of which is a contiguous node range: O(height).
+    size_t subtree_size(uint32_t node) const {
+        size_t total = 0;
+        size_t lo = node, hi = node + 1;  // Current level is [lo, hi).
+        while (lo < hi) {
+            total += hi - lo;
+            size_t next_lo = bits.rank1(bits.select0(lo) + 1);  // Children of [lo, hi) are the ones between
+            size_t next_hi = bits.rank1(bits.select0(hi));      // zero lo and zero hi.
+            lo = next_lo;
+            hi = next_hi;
+        }
+        return total;
+    }
+
+    // Pre-order search below start, matching Tree::find_node and MappedTree::find_node. Empty if the value is absent.
+    optional<LoudsNode> find_node(const LoudsNode &start, const T &value) const {
+        vector<uint32_t> stack = {start.get_index()};
+        while (!stack.empty()) {
+            uint32_t curr = stack.back();
+            stack.pop_back();
+            if (values[curr] == value) return LoudsNode(this, curr);
+            uint32_t first = first_child(curr);
+            if (first != NONE) {
+                for (uint32_t child = first + static_cast<uint32_t>(degree(curr)); child > first; child--) stack.push_back(child - 1);
+            }
+        }
+        return nullopt;
+    }
+
+    // Bytes used by the shape directories and the value array.
+    size_t memory_bytes() const { return bits.memory_bytes() + values.capacity() * sizeof(T); }
+
+    // Bytes the pointer-based layout of the same tree occupies (node objects plus child arrays, before allocator overhead).
+    static size_t pointer_layout_bytes(const Tree<T, K> &tree) {
+        size_t total = 0;
+        vector<const Node<T> *> stack;
+        if (tree.get_root() != nullptr) stack.push_back(tree.get_root());
+        while (!stack.empty()) {
+            const Node<T> *curr = stack.back();
+            stack.pop_back();
+            total += sizeof(Node<T>) + curr->get_children().capacity() * sizeof(Node<T> *);
+            for (auto child : curr->get_children()) stack.push_back(child);
+        }
+        return total;
+    }
+
+    iterator begin_bfs_scan() { return iterator(this, nullptr, 0); }  // BFS is the storage order, so nothing is computed.
+
+    iterator end_bfs_scan() { return iterator(this, nullptr, values.size()); }
+
+    iterator begin_dfs_scan() {
+        dfs_order.clear();  // Clear any existing nodes in the traversal.
+        dfs_order.reserve(values.size());
+        vector<uint32_t> stack;
+        if (!values.empty()) stack.push_back(0);
+        while (!stack.empty()) {
+            uint32_t curr = stack.back();
+            stack.pop_back();
+            dfs_order.push_back(curr);
+            uint32_t first = first_child(curr);
+            if (first != NONE) {
+                for (uint32_t child = first + static_cast<uint32_t>(degree(curr)); child > first; child--) stack.push_back(child - 1);
+            }
+        }
+        return iterator(this, dfs_order.data(), 0);
+    }
+
+    iterator end_dfs_scan() { return iterator(this, dfs_order.data(), dfs_order.size()); }
+
+    iterator begin() { return begin_bfs_scan(); }  // Default traversal is BFS.
+    iterator end() { return end_bfs_scan(); }
+};
+
+#endif // LOUDS_TREE_HPP
@@ -0,0 +1,226 @@
+#ifndef MAPPED_TREE_HPP
+#define MAPPED_TREE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include "buffered_stream.hpp"
+#include "tree.hpp"
+using namespace std;
+
+const char MAPPED_TREE_MAGIC[4] = {'E', 'X', '2', 'M'};  // Tag at the start of every flat tree file.
+const uint32_t MAPPED_TREE_VERSION = 1;  // Bumped whenever the flat layout changes.
+
+// Fixed-size header at offset 0 of a flat tree file.
+struct MappedTreeHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t value_size;  // sizeof(T) of the writer, checked on open.
+    uint32_t k;  // Maximum number of children per node.
+    uint64_t node_count;
+    uint64_t values_offset;  // Byte offset of the packed value array.
+};
+
+/*
+ * Read-only tree served straight from a memory-mapped file.
+ *
+ * File layout (nodes numbered in BFS order, so every node's children are consecutive):
+ *   MappedTreeHeader
+ *   uint32_t first_child[node_count + 1]   children of i are [first_child[i], first_child[i + 1])
+ *   T values[node_count]                   aligned for T, same BFS order
+ *
+ * Nothing in the file is a pointer, so the mapping can be shared by every process that opens it.
+ */
+template <typename T, int K = 2>
+class MappedTree {
+    static_assert(is_trivially_copyable<T>::value, "MappedTree stores values as raw bytes");
+
+public:
+    // Lightweight handle to one node of the mapping.
+    class MappedNode {
+    private:
+        const MappedTree *tree;
+        uint32_t index;
+
+    public:
+        MappedNode(const MappedTree *t, uint32_t i) : tree(t), index(i) {}
+
+        uint32_t get_index() const { return index; }  // Position of the node in BFS order.
+
+        const T &get_value() const { return tree->values[index]; }  // Value read directly from the mapping.
+
+        size_t child_count() const { return tree->first_child[index + 1] - tree->first_child[index]; }
+
+        MappedNode child(size_t i) const { return MappedNode(tree, tree->first_child[index] + static_cast<uint32_t>(i)); }
+
+        bool operator==(const MappedNode &other) const { return tree == other.tree && index == other.index; }
+        bool operator!=(const MappedNode &other) const { return !(*this == other); }
+    };
+
+    class iterator {
+    private:
+        const MappedTree *owner;  // Tree being traversed.
+        const uint32_t *order;  // Visiting order, or nullptr to walk the BFS numbering directly.
+        size_t pos;  // Position within the traversal.
+        MappedNode current;  // Handle for the node at pos, refreshed on access.
+
+        const MappedNode &sync() {
+            current = MappedNode(owner, order == nullptr ? static_cast<uint32_t>(pos) : order[pos]);
+            return current;
+        }
+
+    public:
+        iterator(const MappedTree *t, const uint32_t *ord, size_t p) : owner(t), order(ord), pos(p), current(t, 0) {}
+
+        iterator &operator++() {
+            ++pos;  // Advance to the next node in the traversal.
+            return *this;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return pos != other.pos;  // Compare two iterators for inequality.
+        }
+
+        const MappedNode &operator*() { return sync(); }  // Dereference the iterator to access the node.
+
+        const MappedNode *operator->() { return &sync(); }  // Access the node handle.
+    };
+
+private:
+    void *mapping;  // Start of the mapped file.
+    size_t mapping_size;  // Length of the mapping in bytes.
+    uint64_t node_count;
+    const uint32_t *first_child;  // Child ranges inside the mapping.
+    const T *values;  // Values inside the mapping.
+    vector<uint32_t> dfs_order;  // Scratch order for DFS traversals.
+
+public:
+    explicit MappedTree(const string &path) : mapping(nullptr), mapping_size(0), node_count(0), first_child(nullptr), values(nullptr) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw runtime_error("Cannot open tree file '" + path + "'.");
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(MappedTreeHeader)) {
+            close(fd);
+            throw runtime_error("Not a flat tree file.");
+        }
+        mapping_size = static_cast<size_t>(info.st_size);
+        mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, fd, 0);  // Pages fault in lazily on first access.
+        close(fd);  // The mapping keeps the file alive.
+        if (mapping == MAP_FAILED) throw runtime_error("Cannot map tree file '" + path + "'.");
+
+        const auto *header = static_cast<const MappedTreeHeader *>(mapping);
+        if (header->node_count >= mapping_size) {  // Cheap sanity check before any size arithmetic.
+            munmap(mapping, mapping_size);
+            throw runtime_error("Not a flat tree file.");
+        }
+        uint64_t offsets_end = sizeof(MappedTreeHeader) + (header->node_count + 1) * sizeof(uint32_t);
+        if (memcmp(header->magic, MAPPED_TREE_MAGIC, sizeof(MAPPED_TREE_MAGIC)) != 0 || header->version != MAPPED_TREE_VERSION ||
+            header->value_size != sizeof(T) || header->k > static_cast<uint32_t>(K) || header->values_offset < offsets_end ||
+            header->values_offset % alignof(T) != 0 || header->values_offset + header->node_count * sizeof(T) > mapping_size) {
+            munmap(mapping, mapping_size);
+            throw runtime_error("Flat tree file does not match this tree type.");
+        }
+
+        node_count = header->node_count;
+        first_child = reinterpret_cast<const uint32_t *>(static_cast<const char *>(mapping) + sizeof(MappedTreeHeader));
+        values = reinterpret_cast<const T *>(static_cast<const char *>(mapping) + header->values_offset);
+    }
+
+    ~MappedTree() {
+        if (mapping != nullptr) munmap(mapping, mapping_size);
+    }
+
+    MappedTree(const MappedTree &) = delete;
+    MappedTree &operator=(const MappedTree &) = delete;
+
+    // Writes a tree in the flat layout described above.
+    static void write(const Tree<T, K> &tree, ostream &os) {
+        vector<const Node<T> *> order;  // BFS order of the source tree.
+        if (tree.get_root() != nullptr) order.push_back(tree.get_root());
+        for (size_t i = 0; i < order.size(); i++) {
+            for (auto child : order[i]->get_children()) order.push_back(child);
+        }
+        if (order.size() >= UINT32_MAX) throw runtime_error("Tree is too large for the flat layout.");
+
+        MappedTreeHeader header = {};
+        memcpy(header.magic, MAPPED_TREE_MAGIC, sizeof(MAPPED_TREE_MAGIC));
+        header.version = MAPPED_TREE_VERSION;
+        header.value_size = sizeof(T);
+        header.k = K;
+        header.node_count = order.size();
+        uint64_t offsets_end = sizeof(MappedTreeHeader) + (order.size() + 1) * sizeof(uint32_t);
+        uint64_t align = max<uint64_t>(alignof(T), 8);
+        header.values_offset = (offsets_end + align - 1) / align * align;
+
+        BufferedWriter out(os);
+        out.write_pod(header);
+        uint32_t next = 1;  // The root is node 0, so the first child range starts at 1.
+        for (const Node<T> *node : order) {
+            out.write_pod(next);
+            next += static_cast<uint32_t>(node->get_children().size());
+        }
+        out.write_pod(next);
+        const char padding[8] = {};
+        for (uint64_t pos = offsets_end; pos < header.values_offset; pos++) out.write(padding, 1);
+        for (const Node<T> *node : order) out.write(&node->get_value(), sizeof(T));
+        out.flush();
+        if (!os) throw runtime_error("Failed to write the flat tree.");
+    }
+
+    size_t size() const { return node_count; }  // Number of nodes in the file.
+
+    bool empty() const { return node_count == 0; }
+
+    MappedNode get_root() const {
+        if (node_count == 0) throw runtime_error("Root node not found");
+        return MappedNode(this, 0);
+    }
+
+    // Pre-order search below start, matching Tree::find_node. Empty if the value is absent.
+    optional<MappedNode> find_node(const MappedNode &start, const T &value) const {
+        vector<uint32_t> stack = {start.get_index()};
+        while (!stack.empty()) {
+            uint32_t curr = stack.back();
+            stack.pop_back();
+            if (values[curr] == value) return MappedNode(this, curr);
+            for (uint32_t child = first_child[curr + 1]; child > first_child[curr]; child--) stack.push_back(child - 1);
+        }
+        return nullopt;
+    }
+
+    MappedNode node_at(uint32_t index) const { return MappedNode(this, index); }  // Handle for a BFS index.
+
+    iterator begin_bfs_scan() { return iterator(this, nullptr, 0); }  // BFS is the storage order, so nothing is computed.
+
+    iterator end_bfs_scan() { return iterator(this, nullptr, node_count); }
+
+    iterator begin_dfs_scan() {
+        dfs_order.clear();  // Clear any existing nodes in the traversal.
+        if (node_count > 0) {
+            dfs_order.reserve(node_count);
+            vector<uint32_t> stack = {0};
+            while (!stack.empty()) {
+                uint32_t curr = stack.back();
+                stack.pop_back();
+                dfs_order.push_back(curr);
+                for (uint32_t child = first_child[curr + 1]; child > first_child[curr]; child--) stack.push_back(child - 1);
+            }
+        }
+        return iterator(this, dfs_order.data(), 0);
+    }
+
+    iterator end_dfs_scan() { return iterator(this, dfs_order.data(), dfs_order.size()); }
+
+    iterator begin() { return begin_bfs_scan(); }  // Default traversal is BFS.
+    iterator end() { return end_bfs_scan(); }
+};
+
+#endif // MAPPED_TREE_HPP
@@ -1,29 +1,81 @@
 #ifndef NODE_HPP
 #define NODE_HPP
 
+#include <type_traits>
+#include <utility>
 #include <vector>
 using namespace std;
 
+template <typename T, int K>
+class Tree;
+
 template <typename T>
 class Node {
 private:
     T value;  // The value stored in the node.
     vector<Node<T>*> children;  // The children of this node.
+    Node<T>* parent = nullptr;  // Set when the node is added as a child; null for a root.
+
+    template <typename U, int K>
+    friend class Tree;  // The tree may move values out of nodes handed to it as rvalues.
 
 public:
-    Node(T v) : value(v) {}  // Constructor
+    Node(T v) : value(std::move(v)) {}  // Constructor
+
+    template <typename... Args>
+    explicit Node(in_place_t, Args&&... args) : value(std::forward<Args>(args)...) {}  // Construct the value in place.
+
+    Node(const Node<T>&) = default;  // Shares the child pointers; add_child(const Node&) copies the subtree instead.
+    Node<T>& operator=(const Node<T>&) = default;
+
+    // Steals the value and the children; the source is left without children and detached from its parent.
+    Node(Node<T>&& other) noexcept(is_nothrow_move_constructible<T>::value)
+        : value(std::move(other.value)), children(std::move(other.children)) {
+        other.children.clear();
+    }
 
     ~Node() {
         children.clear();  // Clear children to avoid memory leaks.
     }
 
     void add_child(const Node<T>& child) {
-        children.push_back(new Node<T>(child));  // Add a new child node.
+        children.push_back(new Node<T>(in_place, child.value));  // Add a new child node.
+        children.back()->parent = this;
+        // Copy its subtree too, so no node is shared with child and every copy's parent link points at its copied parent.
+        vector<pair<const Node<T>*, Node<T>*>> stack = {{&child, children.back()}};
+        while (!stack.empty()) {
+            const Node<T>* from = stack.back().first;
+            Node<T>* to = stack.back().second;
+            stack.pop_back();
+            to->children.reserve(from->children.size());
+            for (const Node<T>* grandchild : from->children) {
+                to->children.push_back(new Node<T>(in_place, grandchild->value));
+                to->children.back()->parent = to;
+                stack.emplace_back(grandchild, to->children.back());
+            }
+        }
     }
 
-    T get_value() const { return value; }  // Get the value of the node.
+    void add_child(Node<T>&& child) {
+        children.push_back(new Node<T>(std::move(child)));  // Add a new child node, stealing its value and children.
+        children.back()->parent = this;
+        for (Node<T>* moved : children.back()->children) moved->parent = children.back();  // Its children moved with it.
+    }
+
+    template <typename... Args>
+    Node<T>* emplace_child(Args&&... args) {
+        children.push_back(new Node<T>(in_place, std::forward<Args>(args)...));  // Build the child's value in place.
+        children.back()->parent = this;
+        return children.back();
+    }
+
+    void reserve_children(size_t count) { children.reserve(count); }  // Pre-size the child list for bulk building.
+
+    const T& get_value() const { return value; }  // Get the value of the node.
+
+    const vector<Node<T>*>& get_children() const { return children; }  // Get the children of the node.
 
-    vector<Node<T>*> get_children() const { return children; }  // Get the children of the node.
+    Node<T>* get_parent() const { return parent; }  // The node this one hangs under, or nullptr for a root.
 };
 
 #endif // NODE_HPP
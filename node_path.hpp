@@ -0,0 +1,101 @@
+#ifndef NODE_PATH_HPP
+#define NODE_PATH_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include "node.hpp"
+using namespace std;
+
+/*
+ * Upward walks over the parent links: ancestors(node) yields node's parent, grandparent and so on up to the
+ * root; path_from_root(node) yields the root down to node. Both run in O(depth).
+ */
+
+template <typename T>
+class AncestorRange {
+private:
+    Node<T> *start;  // First node yielded.
+
+public:
+    class iterator {
+    private:
+        Node<T> *node;
+
+    public:
+        using iterator_category = forward_iterator_tag;
+        using value_type = Node<T>;
+        using difference_type = ptrdiff_t;
+        using pointer = Node<T> *;
+        using reference = Node<T> &;
+
+        explicit iterator(Node<T> *n) : node(n) {}
+
+        Node<T> &operator*() const { return *node; }
+        Node<T> *operator->() const { return node; }
+
+        iterator &operator++() {
+            node = node->get_parent();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator before = *this;
+            ++*this;
+            return before;
+        }
+
+        bool operator==(const iterator &other) const { return node == other.node; }
+        bool operator!=(const iterator &other) const { return node != other.node; }
+    };
+
+    explicit AncestorRange(Node<T> *first) : start(first) {}
+
+    iterator begin() const { return iterator(start); }
+    iterator end() const { return iterator(nullptr); }
+};
+
+// The nodes above node, nearest first; empty for a root.
+template <typename T>
+AncestorRange<T> ancestors(Node<T> *node) {
+    return AncestorRange<T>(node == nullptr ? nullptr : node->get_parent());
+}
+
+/*
+ * The nodes from the root down to node, both included. The path is collected bottom-up into an inline
+ * buffer, so paths of up to N nodes cost no allocation; deeper ones spill to the heap once.
+ */
+template <typename T, size_t N = 64>
+class PathFromRoot {
+private:
+    Node<T> *inline_nodes[N];
+    vector<Node<T> *> spilled;
+    Node<T> **first = inline_nodes;
+    size_t count = 0;
+
+public:
+    explicit PathFromRoot(Node<T> *node) {
+        for (Node<T> *curr = node; curr != nullptr; curr = curr->get_parent()) count++;
+        if (count > N) {
+            spilled.resize(count);
+            first = spilled.data();
+        }
+        size_t i = count;
+        for (Node<T> *curr = node; curr != nullptr; curr = curr->get_parent()) first[--i] = curr;
+    }
+
+    PathFromRoot(const PathFromRoot &) = delete;  // first may point into this object's own buffer.
+    PathFromRoot &operator=(const PathFromRoot &) = delete;
+
+    Node<T> *const *begin() const { return first; }
+    Node<T> *const *end() const { return first + count; }
+    size_t size() const { return count; }
+    Node<T> *operator[](size_t i) const { return first[i]; }
+};
+
+template <typename T>
+PathFromRoot<T> path_from_root(Node<T> *node) {
+    return PathFromRoot<T>(node);  // Guaranteed copy elision: the buffer is built in the caller's object.
+}
+
+#endif // NODE_PATH_HPP
@@ -0,0 +1,58 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define EX2_X86_SIMD 1  // SSE2/AVX2 kernels compiled with per-function target attributes, picked at run time.
+#endif
+using namespace std;
+
+const size_t SIMD_ALIGNMENT = 32;  // Byte alignment of SIMD-friendly arrays (one AVX register).
+
+// Allocator handing out SIMD_ALIGNMENT-aligned blocks, so vector loads never straddle cache lines.
+template <typename U>
+struct AlignedAllocator {
+    using value_type = U;
+
+    AlignedAllocator() = default;
+
+    template <typename V>
+    AlignedAllocator(const AlignedAllocator<V> &) {}
+
+    U *allocate(size_t count) {
+        void *block = ::operator new(count * sizeof(U), align_val_t(SIMD_ALIGNMENT));
+        return static_cast<U *>(block);
+    }
+
+    void deallocate(U *block, size_t) { ::operator delete(block, align_val_t(SIMD_ALIGNMENT)); }
+
+    template <typename V>
+    bool operator==(const AlignedAllocator<V> &) const { return true; }
+
+    template <typename V>
+    bool operator!=(const AlignedAllocator<V> &) const { return false; }
+};
+
+template <typename U>
+using AlignedVector = vector<U, AlignedAllocator<U>>;
+
+using AlignedDoubles = AlignedVector<double>;
+
+enum class SimdLevel { SCALAR, SSE2, AVX2 };
+
+// Best instruction set this CPU supports, detected once.
+inline SimdLevel simd_level() {
+    static const SimdLevel level = [] {
+#ifdef EX2_X86_SIMD
+        if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+        if (__builtin_cpu_supports("sse2")) return SimdLevel::SSE2;
+#endif
+        return SimdLevel::SCALAR;
+    }();
+    return level;
+}
+
+#endif // SIMD_HPP
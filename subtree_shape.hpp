@@ -0,0 +1,107 @@
+#ifndef SUBTREE_SHAPE_HPP
+#define SUBTREE_SHAPE_HPP
+
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include "node.hpp"
+using namespace std;
+
+// Where a node sits in the tree.
+struct NodeShape {
+    size_t size;  // Nodes in its subtree, itself included.
+    size_t depth;  // Edges from the root.
+};
+
+/*
+ * Subtree size and depth of every node, plus the size and height of the whole tree. Kept current by the
+ * tree on add_sub_node (O(depth)) and rebuilt in one pass after any other change. The sizes give
+ * positional access: the k-th node in pre-order is found by skipping whole subtrees.
+ */
+template <typename T>
+class SubtreeShape {
+private:
+    unordered_map<const Node<T> *, NodeShape> shapes;
+    size_t levels = 0;  // Height of the tree in levels; 0 when empty.
+    uint64_t version = UINT64_MAX;  // Tree version the shapes describe.
+
+public:
+    bool is_current(uint64_t tree_version) const { return version == tree_version; }
+
+    void clear() {
+        shapes.clear();
+        levels = 0;
+        version = UINT64_MAX;
+    }
+
+    void rebuild(Node<T> *root, uint64_t tree_version) {
+        shapes.clear();
+        levels = 0;
+        vector<Node<T> *> order;  // Pre-order, so children follow their parent.
+        vector<Node<T> *> parent;
+        vector<pair<Node<T> *, Node<T> *>> stack;  // (node, parent)
+        if (root != nullptr) stack.push_back({root, nullptr});
+        while (!stack.empty()) {
+            auto [node, from] = stack.back();
+            stack.pop_back();
+            size_t depth = from == nullptr ? 0 : shapes.at(from).depth + 1;
+            shapes.emplace(node, NodeShape{1, depth});
+            levels = max(levels, depth + 1);
+            order.push_back(node);
+            parent.push_back(from);
+            const auto &children = node->get_children();
+            for (size_t i = children.size(); i > 0; i--) stack.push_back({children[i - 1], node});
+        }
+        for (size_t i = order.size(); i > 1; i--) shapes.at(parent[i - 1]).size += shapes.at(order[i - 1]).size;
+        version = tree_version;
+    }
+
+    // Records a new leaf under path.back(); path runs from the root to the parent. If the path passes a node
+    // that was added directly without mark_changed(), the shapes are marked stale for a rebuild instead.
+    void insert(const vector<Node<T> *> &path, const Node<T> *child, uint64_t tree_version) {
+        for (Node<T> *node : path) {
+            auto found = shapes.find(node);
+            if (found == shapes.end()) {
+                version = UINT64_MAX;
+                return;
+            }
+            found->second.size++;
+        }
+        shapes.emplace(child, NodeShape{1, path.size()});
+        levels = max(levels, path.size() + 1);
+        version = tree_version;
+    }
+
+    const NodeShape &shape(const Node<T> *node) const { return shapes.at(node); }
+
+    bool contains(const Node<T> *node) const { return shapes.count(node) > 0; }
+
+    size_t size() const { return shapes.size(); }
+
+    size_t height() const { return levels; }
+
+    // Node at position index of root's subtree in pre-order, in O(depth * K). Returns nullptr if index is out of
+    // range or the walk meets a node added directly without mark_changed(); the caller rebuilds and retries.
+    Node<T> *node_at(Node<T> *root, size_t index) const {
+        auto recorded = shapes.find(root);
+        if (root == nullptr || recorded == shapes.end() || index >= recorded->second.size) return nullptr;
+        Node<T> *node = root;
+        while (index > 0) {
+            index--;  // Step past node itself into its children.
+            for (Node<T> *child : node->get_children()) {
+                auto found = shapes.find(child);
+                if (found == shapes.end()) return nullptr;
+                size_t below = found->second.size;
+                if (index < below) {
+                    node = child;
+                    break;
+                }
+                index -= below;  // Skip the whole subtree.
+            }
+        }
+        return node;
+    }
+};
+
+#endif // SUBTREE_SHAPE_HPP
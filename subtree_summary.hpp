@@ -0,0 +1,124 @@
+#ifndef SUBTREE_SUMMARY_HPP
+#define SUBTREE_SUMMARY_HPP
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <unordered_map>
+#include <vector>
+#include "node.hpp"
+using namespace std;
+
+// True for types with an operator< usable on const values; only those can have subtree summaries.
+template <typename T, typename = void>
+struct is_less_comparable : false_type {};
+
+template <typename T>
+struct is_less_comparable<T, void_t<decltype(declval<const T &>() < declval<const T &>())>> : true_type {};
+
+// Path from start to the first node in pre-order holding value, or empty. Subtrees whose root fails
+// may_contain(node) are not entered.
+template <typename T, typename Filter>
+void find_pruned_path(Node<T> *start, const T &value, vector<Node<T> *> &path, Filter may_contain) {
+    path.clear();
+    if (start == nullptr || !may_contain(start)) return;
+    path.push_back(start);
+    if (start->get_value() == value) return;
+    vector<size_t> next = {0};  // Next child to try at each level of the path.
+    while (!path.empty()) {
+        const auto &children = path.back()->get_children();
+        if (next.back() == children.size()) {
+            path.pop_back();
+            next.pop_back();
+            continue;
+        }
+        Node<T> *child = children[next.back()++];
+        if (!may_contain(child)) continue;  // Nothing in this subtree can match.
+        path.push_back(child);
+        if (child->get_value() == value) return;
+        next.push_back(0);
+    }
+}
+
+// Smallest and largest value in a subtree, ordered by T's operator<.
+template <typename T>
+struct ValueRange {
+    T low;
+    T high;
+};
+
+/*
+ * Min/max value of every subtree, so searches can skip subtrees whose range cannot hold the key. Only
+ * operator< is used: a subtree is skipped when key < low or high < key. Kept current by the tree on
+ * add_sub_node (O(depth)) and rebuilt in one pass after any other change.
+ */
+template <typename T>
+class SubtreeSummary {
+private:
+    unordered_map<const Node<T> *, ValueRange<T>> ranges;
+    uint64_t version = UINT64_MAX;  // Tree version the ranges describe.
+
+    static void widen(ValueRange<T> &range, const T &value) {
+        if (value < range.low) range.low = value;
+        if (range.high < value) range.high = value;
+    }
+
+public:
+    bool is_current(uint64_t tree_version) const { return version == tree_version; }
+
+    size_t size() const { return ranges.size(); }
+
+    void clear() {
+        ranges.clear();
+        version = UINT64_MAX;
+    }
+
+    void rebuild(Node<T> *root, uint64_t tree_version) {
+        ranges.clear();
+        vector<pair<Node<T> *, size_t>> stack;  // (node, next child): the path to the current node.
+        if (root != nullptr) stack.push_back({root, 0});
+        while (!stack.empty()) {
+            Node<T> *node = stack.back().first;
+            const auto &children = node->get_children();
+            if (stack.back().second < children.size()) {
+                stack.push_back({children[stack.back().second++], 0});
+                continue;
+            }
+            ValueRange<T> range{node->get_value(), node->get_value()};  // Children are done: merge their ranges.
+            for (Node<T> *child : children) {
+                const ValueRange<T> &below = ranges.at(child);
+                if (below.low < range.low) range.low = below.low;
+                if (range.high < below.high) range.high = below.high;
+            }
+            ranges.emplace(node, std::move(range));
+            stack.pop_back();
+        }
+        version = tree_version;
+    }
+
+    // Records a new leaf under path.back(); path runs from the root to the parent.
+    void insert(const vector<Node<T> *> &path, const Node<T> *child, uint64_t tree_version) {
+        for (Node<T> *node : path) widen(ranges.at(node), child->get_value());
+        ranges.emplace(child, ValueRange<T>{child->get_value(), child->get_value()});
+        version = tree_version;
+    }
+
+    const ValueRange<T> &range(const Node<T> *node) const { return ranges.at(node); }
+
+    bool may_contain(const Node<T> *node, const T &value) const {
+        const ValueRange<T> &range = ranges.at(node);
+        return !(value < range.low) && !(range.high < value);
+    }
+
+    bool overlaps(const Node<T> *node, const T &low, const T &high) const {
+        const ValueRange<T> &range = ranges.at(node);
+        return !(range.high < low) && !(high < range.low);
+    }
+
+    // Path from start to the first node in pre-order holding value; empty if there is none.
+    void find_path(Node<T> *start, const T &value, vector<Node<T> *> &path) const {
+        find_pruned_path(start, value, path, [&](const Node<T> *node) { return may_contain(node, value); });
+    }
+};
+
+#endif // SUBTREE_SUMMARY_HPP
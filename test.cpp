@@ -1,7 +1,18 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
+#include "complex.hpp"
+#include "complex_array.hpp"
+#include <sstream>
 #include "node.hpp"
 #include "tree.hpp"
+#include "mapped_tree.hpp"
+#include "louds_tree.hpp"
+#include "edge_list_importer.hpp"
+#include "layout_grid.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
 
 TEST_CASE("Test Tree Construction and Root Addition") {
     Tree<int> tree;
@@ -260,3 +271,1077 @@ TEST_CASE("Test 3-ary Tree Traversals (Pre-Order, Post-Order, In-Order should de
         CHECK(index == expected_values.size());
     }
 }
+
+TEST_CASE("Test Emplace And Move Insertion") {
+    Tree<string, 3> tree;
+    string payload(4096, 'x');
+
+    Node<string> *root = tree.emplace_root("root");
+    CHECK(root == tree.get_root());
+
+    Node<string> *big = tree.emplace_sub_node("root", payload);
+    Node<string> *filled = tree.emplace_sub_node("root", size_t(3), 'z');  // Constructs string(3, 'z') in place.
+    CHECK(big->get_value() == payload);
+    CHECK(filled->get_value() == "zzz");
+
+    Node<string> parent("root"), child(string(2048, 'y'));
+    tree.add_sub_node(parent, std::move(child));
+    CHECK(tree.get_root()->get_children().size() == 3);
+    CHECK(tree.get_root()->get_children()[2]->get_value() == string(2048, 'y'));
+
+    CHECK_THROWS(tree.emplace_root("again"));
+    CHECK_THROWS(tree.emplace_sub_node("root", "full"));
+    CHECK_THROWS(tree.emplace_sub_node("missing", "child"));
+
+    const string &ref = tree.find_node(tree.get_root(), "zzz")->get_value();
+    CHECK(&ref == &filled->get_value());  // get_value returns a reference, not a copy.
+}
+
+struct CopyCounter {  // Counts copies, so tests can tell a move from a copy.
+    static int copies;
+    int id;
+    CopyCounter(int i) : id(i) {}
+    CopyCounter(const CopyCounter &other) : id(other.id) { copies++; }
+    CopyCounter(CopyCounter &&other) noexcept : id(other.id) {}
+    bool operator==(const CopyCounter &other) const { return id == other.id; }
+};
+int CopyCounter::copies = 0;
+
+TEST_CASE("Test Node Move Insertion Steals Children") {
+    Node<CopyCounter> holder(0), source(1);
+    source.emplace_child(2);
+    CopyCounter::copies = 0;
+    holder.add_child(std::move(source));
+    CHECK(CopyCounter::copies == 0);  // The value is moved, not copied.
+    CHECK(source.get_children().empty());  // The children moved too, so nothing is shared.
+    Node<CopyCounter> *moved = holder.get_children()[0];
+    REQUIRE(moved->get_children().size() == 1);
+    CHECK(moved->get_children()[0]->get_parent() == moved);
+    delete moved->get_children()[0];
+    delete moved;
+
+    // Moving a node that belongs to a tree hands its subtree over; the destructor frees every node once.
+    // Build with -DEX2_SANITIZE=ON (or make SANITIZE=1) to have ASan check this.
+    Tree<int, 3> tree;
+    Node<int> *a = tree.emplace_root(1);
+    Node<int> *c = tree.emplace_sub_node(1, 3);
+    tree.emplace_sub_node(3, 4);
+    a->add_child(std::move(*c));
+    tree.mark_changed();
+    CHECK(c->get_children().empty());
+    REQUIRE(a->get_children().size() == 2);
+    Node<int> *copy = a->get_children()[1];
+    REQUIRE(copy->get_children().size() == 1);
+    CHECK(copy->get_children()[0]->get_value() == 4);
+    CHECK(copy->get_children()[0]->get_parent() == copy);
+}
+
+TEST_CASE("Test Save And Load") {
+    Tree<int, 3> tree;
+    Node<int> root_node(1);
+    tree.add_root(root_node);
+
+    Node<int> n1(2), n2(3), n3(4), n4(5), n5(6);
+    tree.add_sub_node(root_node, n1);
+    tree.add_sub_node(root_node, n2);
+    tree.add_sub_node(root_node, n3);
+    tree.add_sub_node(n1, n4);
+    tree.add_sub_node(n3, n5);
+
+    stringstream buffer;
+    tree.save(buffer);
+
+    Tree<int, 3> loaded;
+    loaded.load(buffer);
+
+    vector<int> expected_values = {1, 2, 5, 3, 4, 6};
+    size_t index = 0;
+    for (auto it = loaded.begin_dfs_scan(); it != loaded.end_dfs_scan(); ++it) {
+        CHECK((*it).get_value() == expected_values[index]);
+        index++;
+    }
+    CHECK(index == expected_values.size());
+
+    SUBCASE("Strings round trip") {
+        Tree<string> words;
+        words.emplace_root("root");
+        words.emplace_sub_node("root", "");
+        words.emplace_sub_node("root", string(10000, 'q'));
+
+        stringstream word_buffer;
+        words.save(word_buffer);
+        Tree<string> loaded_words;
+        loaded_words.load(word_buffer);
+        CHECK(loaded_words.get_root()->get_value() == "root");
+        CHECK(loaded_words.get_root()->get_children()[0]->get_value() == "");
+        CHECK(loaded_words.get_root()->get_children()[1]->get_value() == string(10000, 'q'));
+    }
+
+    SUBCASE("Leaves data after the tree in the stream") {
+        Tree<string> words;
+        words.emplace_root("first");
+        words.emplace_sub_node("first", string(5000, 'w'));
+
+        stringstream both;
+        tree.save(both);
+        words.save(both);
+        tree.save(both);
+        both << "tail";
+
+        Tree<int, 3> first, third;
+        Tree<string> second;
+        first.load(both);
+        second.load(both);
+        third.load(both);
+        CHECK(first.get_root()->get_children().size() == 3);
+        CHECK(second.get_root()->get_children()[0]->get_value() == string(5000, 'w'));
+        CHECK(third.find_node(6) != nullptr);
+        string rest;
+        both >> rest;
+        CHECK(rest == "tail");
+    }
+
+    SUBCASE("Rejects bad input") {
+        stringstream garbage("not a tree");
+        CHECK_THROWS(loaded.load(garbage));
+
+        string bytes = buffer.str();
+        stringstream truncated(bytes.substr(0, bytes.size() - 2));
+        CHECK_THROWS(loaded.load(truncated));
+
+        Tree<int> binary;  // Root has three children, which a binary tree cannot hold.
+        stringstream too_wide(bytes);
+        CHECK_THROWS(binary.load(too_wide));
+        CHECK(loaded.get_root()->get_value() == 1);  // A failed load leaves the tree untouched.
+    }
+
+    SUBCASE("Rejects truncated and oversized headers") {
+        string bytes = buffer.str();
+        const size_t count_offset = 10;  // Magic, version, count width and value size come first.
+        stringstream header_only(bytes.substr(0, count_offset + 3));
+        CHECK_THROWS_AS(loaded.load(header_only), runtime_error);
+
+        string huge_count = bytes;
+        uint64_t claimed = uint64_t(1) << 60;  // Far more nodes than the stream holds.
+        memcpy(&huge_count[count_offset], &claimed, sizeof(claimed));
+        stringstream oversized(huge_count);
+        CHECK_THROWS_AS(loaded.load(oversized), runtime_error);  // Not bad_alloc or length_error.
+
+        Tree<string> words;
+        words.emplace_root("root");
+        stringstream word_buffer;
+        words.save(word_buffer);
+        string word_bytes = word_buffer.str();
+        uint64_t claimed_length = uint64_t(1) << 50;
+        memcpy(&word_bytes[count_offset + sizeof(uint64_t) + 1], &claimed_length, sizeof(claimed_length));  // After one count.
+        stringstream long_string(word_bytes);
+        Tree<string> loaded_words;
+        CHECK_THROWS_AS(loaded_words.load(long_string), runtime_error);
+        CHECK(loaded.get_root()->get_value() == 1);
+    }
+
+    SUBCASE("Rejects counts that close the tree early") {
+        Tree<int, 3> two;  // Counts [0, 1]: they sum to count - 1, but the root is a leaf.
+        two.emplace_root(1);
+        two.emplace_sub_node(1, 2);
+        string bytes;
+        {
+            stringstream out;
+            two.save(out);
+            bytes = out.str();
+        }
+        size_t counts = bytes.size() - 2 * sizeof(int) - 2;  // Counts are one byte each for K = 3.
+        CHECK(bytes[counts] == 1);
+        CHECK(bytes[counts + 1] == 0);
+        swap(bytes[counts], bytes[counts + 1]);
+        stringstream early(bytes);
+        CHECK_THROWS(loaded.load(early));
+
+        bytes[counts] = 0;  // Counts [0, 0]: the second node has no parent either.
+        bytes[counts + 1] = 0;
+        stringstream orphan(bytes);
+        CHECK_THROWS(loaded.load(orphan));
+        CHECK(loaded.get_root()->get_value() == 1);
+    }
+}
+
+TEST_CASE("Test Memory-Mapped Tree") {
+    Tree<int, 3> tree;
+    Node<int> root_node(1);
+    tree.add_root(root_node);
+
+    Node<int> n1(2), n2(3), n3(4), n4(5), n5(6);
+    tree.add_sub_node(root_node, n1);
+    tree.add_sub_node(root_node, n2);
+    tree.add_sub_node(n1, n3);
+    tree.add_sub_node(n1, n4);
+    tree.add_sub_node(n2, n5);
+
+    const string path = "mapped_tree_test.bin";
+    {
+        ofstream file(path, ios::binary);
+        MappedTree<int, 3>::write(tree, file);
+    }
+
+    MappedTree<int, 3> mapped(path);
+    CHECK(mapped.size() == 6);
+    CHECK(mapped.get_root().get_value() == 1);
+    CHECK(mapped.get_root().child_count() == 2);
+    CHECK(mapped.get_root().child(1).get_value() == 3);
+
+    vector<int> bfs_expected = {1, 2, 3, 4, 5, 6};
+    size_t index = 0;
+    for (auto it = mapped.begin_bfs_scan(); it != mapped.end_bfs_scan(); ++it) {
+        CHECK((*it).get_value() == bfs_expected[index]);
+        index++;
+    }
+    CHECK(index == bfs_expected.size());
+
+    vector<int> dfs_expected = {1, 2, 4, 5, 3, 6};
+    index = 0;
+    for (auto it = mapped.begin_dfs_scan(); it != mapped.end_dfs_scan(); ++it) {
+        CHECK(it->get_value() == dfs_expected[index]);
+        index++;
+    }
+    CHECK(index == dfs_expected.size());
+
+    auto found = mapped.find_node(mapped.get_root(), 5);
+    CHECK(found.has_value());
+    CHECK(found->get_value() == 5);
+    CHECK(found->child_count() == 0);
+    CHECK_FALSE(mapped.find_node(mapped.get_root(), 42).has_value());
+
+    CHECK_THROWS(MappedTree<double, 3>(path));  // Value type mismatch.
+    CHECK_THROWS(MappedTree<int, 2>(path));  // Written for a wider tree.
+    remove(path.c_str());
+}
+
+TEST_CASE("Test LOUDS Tree") {
+    Tree<int, 3> tree;
+    vector<Node<int> *> nodes = {tree.emplace_root(0)};
+    vector<uint32_t> parent_of = {LoudsTree<int, 3>::NONE};
+    unsigned seed = 7;
+    for (int i = 1; i < 3000; i++) {  // Random shape, built directly so every node knows its parent.
+        seed = seed * 1103515245 + 12345;
+        size_t parent = (seed >> 8) % nodes.size();
+        if (nodes[parent]->get_children().size() == 3) parent = nodes.size() - 1;
+        nodes.push_back(nodes[parent]->emplace_child(i));
+        parent_of.push_back(static_cast<uint32_t>(parent));
+    }
+
+    LoudsTree<int, 3> louds(tree);
+    CHECK(louds.size() == nodes.size());
+
+    // Map BFS positions back to the original node ids to check every navigation step.
+    vector<int> bfs_values;
+    for (auto it = tree.begin_bfs_scan(); it != tree.end_bfs_scan(); ++it) bfs_values.push_back((*it).get_value());
+    vector<uint32_t> bfs_index(nodes.size());
+    for (size_t i = 0; i < bfs_values.size(); i++) bfs_index[bfs_values[i]] = static_cast<uint32_t>(i);
+
+    vector<size_t> sizes(nodes.size(), 1);
+    for (size_t i = nodes.size() - 1; i > 0; i--) sizes[parent_of[i]] += sizes[i];  // Parents precede children.
+
+    for (size_t id = 0; id < nodes.size(); id++) {
+        uint32_t pos = bfs_index[id];
+        const auto &children = nodes[id]->get_children();
+        CHECK(louds.node_at(pos).get_value() == static_cast<int>(id));
+        CHECK(louds.degree(pos) == children.size());
+        CHECK(louds.parent(pos) == (id == 0 ? LoudsTree<int, 3>::NONE : bfs_index[parent_of[id]]));
+        CHECK(louds.first_child(pos) == (children.empty() ? LoudsTree<int, 3>::NONE : bfs_index[children[0]->get_value()]));
+        CHECK(louds.subtree_size(pos) == sizes[id]);
+        for (size_t c = 0; c < children.size(); c++) {
+            uint32_t expected = c + 1 < children.size() ? bfs_index[children[c + 1]->get_value()] : LoudsTree<int, 3>::NONE;
+            CHECK(louds.next_sibling(bfs_index[children[c]->get_value()]) == expected);
+        }
+    }
+
+    size_t index = 0;
+    auto expected = tree.begin_dfs_scan();
+    for (auto it = louds.begin_dfs_scan(); it != louds.end_dfs_scan(); ++it, ++expected) {
+        CHECK(it->get_value() == (*expected).get_value());
+        index++;
+    }
+    CHECK(index == nodes.size());
+
+    auto found = louds.find_node(louds.get_root(), 1234);
+    CHECK(found.has_value());
+    CHECK(found->get_index() == bfs_index[1234]);
+    CHECK(found->get_value() == 1234);
+    CHECK_FALSE(louds.find_node(louds.get_root(), -1).has_value());
+    CHECK_FALSE(louds.find_node(louds.node_at(bfs_index[1]), 0).has_value());  // The root is not below node 1.
+    CHECK(louds.memory_bytes() < LoudsTree<int, 3>::pointer_layout_bytes(tree));
+}
+
+TEST_CASE("Test Edge List Import") {
+    const string path = "edge_list_test.txt";
+    {
+        ofstream file(path);
+        file << "1,2\n"
+             << "  1 3\r\n"
+             << "\n"
+             << "4,7\n"  // Parent 4 does not exist yet.
+             << "2, 4\n"
+             << "2\t5\n"
+             << "3,6";  // No trailing newline.
+    }
+
+    for (size_t block_size : {size_t(3), size_t(7), IMPORT_BLOCK_SIZE}) {
+        for (unsigned threads : {1u, 3u}) {
+            Tree<int> tree;
+            import_edge_list(path, tree, threads, block_size);
+
+            vector<int> expected_values = {1, 2, 3, 4, 5, 6, 7};
+            size_t index = 0;
+            for (auto it = tree.begin_bfs_scan(); it != tree.end_bfs_scan(); ++it) {
+                CHECK((*it).get_value() == expected_values[index]);
+                index++;
+            }
+            CHECK(index == expected_values.size());
+        }
+    }
+
+    SUBCASE("Root edges may come last") {
+        vector<pair<string, vector<int>>> cases = {
+            {"2,4\n1,2\n1,3\n", {1, 2, 3, 4}},  // The root's edges follow an edge further down.
+            {"3,5\n1,2\n2,3\n", {1, 2, 3, 5}},  // 1 -> 2 waits until 2 -> 3 lifts the root twice.
+            {"2,4\n1,3\n1,2\n", {1, 2, 3, 4}},  // The new root adopts the child that waited for it.
+        };
+        for (const auto &entry : cases) {
+            {
+                ofstream file(path);
+                file << entry.first;
+            }
+            Tree<int> tree;
+            import_edge_list(path, tree, 2);
+            vector<int> values;
+            for (auto it = tree.begin_bfs_scan(); it != tree.end_bfs_scan(); ++it) values.push_back(it->get_value());
+            CHECK(values == entry.second);
+            CHECK(tree.get_root()->get_parent() == nullptr);
+            CHECK(tree.get_root()->get_children()[0]->get_parent() == tree.get_root());
+        }
+    }
+
+    SUBCASE("String values") {
+        {
+            ofstream file(path);
+            file << "root,left\nroot right\nleft,leaf\n";
+        }
+        Tree<string> tree;
+        import_edge_list(path, tree, 2);
+        CHECK(tree.get_root()->get_value() == "root");
+        CHECK(tree.find_node(tree.get_root(), "leaf") != nullptr);
+    }
+
+    SUBCASE("Errors") {
+        {
+            ofstream file(path);
+            file << "1,2\n1,x\n";
+        }
+        Tree<int> malformed;
+        CHECK_THROWS(import_edge_list(path, malformed, 2));
+
+        {
+            ofstream file(path);
+            file << "1,2\n9,10\n";
+        }
+        Tree<int> orphan;
+        CHECK_THROWS_WITH(import_edge_list(path, orphan, 2), "Edge list has more than one root.");
+
+        {
+            ofstream file(path);
+            file << "1,2\n1,3\n1,4\n";
+        }
+        Tree<int> full;
+        CHECK_THROWS(import_edge_list(path, full, 2));
+        CHECK_THROWS(import_edge_list("missing_edge_list.txt", full));
+
+        {
+            ofstream file(path);
+            file << "1,2\n1,3\n3,9\n2,9\n9,100\n";  // Which 9 is the parent of 100 would be ambiguous.
+        }
+        Tree<int> duplicate;
+        CHECK_THROWS(import_edge_list(path, duplicate, 2));
+
+        {
+            ofstream file(path);
+            file << "1,2\n2,1\n";  // Every parent is also a child.
+        }
+        Tree<int> cycle;
+        CHECK_THROWS_WITH(import_edge_list(path, cycle, 2), "Edge list has no root.");
+    }
+
+    SUBCASE("Existing duplicates resolve like find_node") {
+        Tree<int> tree;
+        tree.emplace_root(1);
+        Node<int> *two = tree.emplace_sub_node(1, 2);
+        Node<int> *three = tree.emplace_sub_node(1, 3);
+        three->emplace_child(9);  // Inserted first, but second in pre-order.
+        Node<int> *first_nine = two->emplace_child(9);
+        tree.mark_changed();
+
+        TreeBuilder<int> builder(tree);
+        builder.add_edge(9, 100);
+        CHECK(tree.find_node(9) == first_nine);
+        CHECK(first_nine->get_children().size() == 1);
+        CHECK(first_nine->get_children()[0]->get_value() == 100);
+    }
+    remove(path.c_str());
+}
+
+TEST_CASE("Test Layout Cache") {
+    Tree<int> tree;
+    Node<int> root_node(1), n1(2), n2(3);
+    tree.add_root(root_node);
+    tree.add_sub_node(root_node, n1);
+
+    const TreeLayout<int> &layout = tree.get_layout(750);
+    CHECK(layout.size() == 2);
+    CHECK(layout.nodes[0] == tree.get_root());
+    CHECK(layout.parents[0] == NO_PARENT);
+    CHECK(layout.parents[1] == 0);
+    CHECK(layout.positions[0].x == 375);
+    CHECK(layout.positions[1].y == layout.positions[0].y + NODE_RADIUS * 3);
+
+    uint64_t version = layout.version;
+    CHECK(tree.get_layout(750).version == version);  // Unchanged tree: no recomputation.
+
+    tree.add_sub_node(root_node, n2);
+    CHECK(tree.get_layout(750).version != version);  // Mutation invalidates the cache.
+    CHECK(layout.size() == 3);
+    CHECK(layout.positions[1].x < layout.positions[0].x);
+    CHECK(layout.positions[2].x > layout.positions[0].x);
+}
+
+TEST_CASE("Test Tidy Layout") {
+    Tree<int, 3> tree;  // Uneven 3-ary tree: nodes get 0..3 children depending on their value.
+    Node<int> *root = tree.emplace_root(0);
+    vector<Node<int> *> frontier = {root};
+    int next = 1;
+    for (size_t i = 0; i < frontier.size() && next < 2000; i++) {
+        int children = i == 0 ? 3 : frontier[i]->get_value() % 4;
+        for (int c = 0; c < children; c++) frontier.push_back(frontier[i]->emplace_child(next++));
+    }
+    tree.mark_changed();
+
+    const TreeLayout<int> &layout = tree.get_layout(750);
+    REQUIRE(layout.size() == static_cast<size_t>(next));
+    CHECK(layout.positions[0].x == 375);
+
+    map<float, vector<float>> levels;  // y -> x of every node on that level.
+    for (size_t i = 0; i < layout.size(); i++) levels[layout.positions[i].y].push_back(layout.positions[i].x);
+    for (auto &level : levels) {  // No two nodes on a level closer than NODE_DISTANCE.
+        sort(level.second.begin(), level.second.end());
+        for (size_t i = 1; i < level.second.size(); i++) CHECK(level.second[i] - level.second[i - 1] >= NODE_DISTANCE - 0.01f);
+    }
+    for (size_t i = 0; i < layout.size(); i++) {  // Parents are centered over their first and last child.
+        const auto &children = layout.nodes[i]->get_children();
+        if (children.empty()) continue;
+        float first = 0, last = 0;
+        for (size_t j = i + 1; j < layout.size(); j++) {
+            if (layout.nodes[j] == children.front()) first = layout.positions[j].x;
+            if (layout.nodes[j] == children.back()) {
+                last = layout.positions[j].x;
+                break;
+            }
+        }
+        CHECK(layout.positions[i].x == doctest::Approx((first + last) / 2).epsilon(0.0001));
+    }
+
+    Tree<int> chain;  // Deep tree: the layout must not recurse per level.
+    Node<int> *curr = chain.emplace_root(0);
+    for (int i = 1; i < 10000; i++) curr = curr->emplace_child(i);
+    chain.mark_changed();
+    const TreeLayout<int> &deep = chain.get_layout(750);
+    CHECK(deep.size() == 10000);
+    CHECK(deep.positions[9999].x == 375);
+    CHECK(deep.positions[9999].y == NODE_RADIUS * 2 + 9999 * NODE_RADIUS * 3);
+}
+
+TEST_CASE("Test Layout Snapshot") {
+    Tree<int> tree;
+    tree.emplace_root(1);
+    tree.emplace_sub_node(1, 2);
+
+    shared_ptr<const TreeLayout<int>> snapshot = tree.snapshot(750);
+    CHECK(snapshot->size() == 2);
+    CHECK(snapshot->nodes.empty());  // No pointers into the live tree.
+    CHECK(snapshot->label(1) == "2");
+
+    tree.emplace_sub_node(1, 3);  // Later changes do not reach the snapshot.
+    CHECK(snapshot->size() == 2);
+    CHECK(tree.snapshot(750)->size() == 3);
+}
+
+TEST_CASE("Test SVG Export") {
+    Tree<string> tree;
+    tree.emplace_root("a<b");
+    tree.emplace_sub_node("a<b", "x & y");
+
+    ostringstream svg;
+    tree.export_svg(svg);
+    string text = svg.str();
+    CHECK(text.rfind("<svg xmlns=\"http://www.w3.org/2000/svg\"", 0) == 0);
+    CHECK(text.find("<line x1=\"375.0\" y1=\"100.0\" x2=\"375.0\" y2=\"250.0\"/>") != string::npos);
+    CHECK(text.find("<circle cx=\"375.0\" cy=\"250.0\" r=\"50.0\"") != string::npos);
+    CHECK(text.find(">a&lt;b</text>") != string::npos);  // Labels are XML-escaped.
+    CHECK(text.find(">x &amp; y</text>") != string::npos);
+    CHECK(text.substr(text.size() - 7) == "</svg>\n");
+
+    size_t circles = 0;
+    for (size_t at = text.find("<circle"); at != string::npos; at = text.find("<circle", at + 1)) circles++;
+    CHECK(circles == 2);
+}
+
+TEST_CASE("Test Text Outputs") {
+    Tree<double> tree;
+    tree.emplace_root(1.1);
+    tree.emplace_sub_node(1.1, 1.2);
+    tree.emplace_sub_node(1.1, 1.3);
+    tree.emplace_sub_node(1.2, 1.4);
+
+    ostringstream ascii, dot, csv;
+    tree.write_ascii(ascii);
+    tree.write_dot(dot);
+    tree.write_csv(csv);
+    CHECK(ascii.str() == "1.1\n+-- 1.2\n|   `-- 1.4\n`-- 1.3\n");
+    CHECK(dot.str() == "digraph tree {\n  n0 [label=\"1.1\"];\n  n1 [label=\"1.2\"];\n  n0 -> n1;\n"
+                       "  n2 [label=\"1.4\"];\n  n1 -> n2;\n  n3 [label=\"1.3\"];\n  n0 -> n3;\n}\n");
+    CHECK(csv.str() == "id,parent,depth,value\n0,,0,\"1.1\"\n1,0,1,\"1.2\"\n2,1,2,\"1.4\"\n3,0,1,\"1.3\"\n");
+
+    Tree<string> quoted;
+    quoted.emplace_root("say \"hi\"");
+    ostringstream quoted_dot, quoted_csv;
+    quoted.write_dot(quoted_dot);
+    quoted.write_csv(quoted_csv);
+    CHECK(quoted_dot.str().find("[label=\"say \\\"hi\\\"\"]") != string::npos);
+    CHECK(quoted_csv.str().find("0,,0,\"say \"\"hi\"\"\"") != string::npos);
+
+    Tree<int> empty;
+    ostringstream nothing;
+    empty.write_ascii(nothing);
+    CHECK(nothing.str().empty());
+
+    Tree<double> small;  // None of these has an exact short decimal form, and one decimal would print 0.0 for all.
+    vector<double> values = {0.01, 0.04, 1e-9, 0.1 + 0.2};
+    small.emplace_root(values[0]);
+    for (size_t i = 1; i < values.size(); i++) small.emplace_sub_node(values[i - 1], values[i]);
+    ostringstream small_csv, small_dot;
+    small.write_csv(small_csv);
+    small.write_dot(small_dot);
+    istringstream lines(small_csv.str());
+    string line;
+    getline(lines, line);  // Header.
+    for (double expected : values) {
+        REQUIRE(getline(lines, line));
+        size_t quote = line.find('"');
+        CHECK(strtod(line.c_str() + quote + 1, nullptr) == expected);  // Reads back to the same double.
+    }
+    CHECK(small_dot.str().find("[label=\"1e-09\"]") != string::npos);
+}
+
+TEST_CASE("Test Layout Labels") {
+    Tree<double> doubles;
+    doubles.emplace_root(1.1);
+    doubles.emplace_sub_node(1.1, -2.0);
+    const TreeLayout<double> &double_layout = doubles.get_layout(750);
+    CHECK(double_layout.label(0) == "1.1");
+    CHECK(double_layout.label(1) == "-2.0");
+
+    Tree<int> ints;
+    ints.emplace_root(42);
+    CHECK(ints.get_layout(750).label(0) == "42");
+
+    Tree<string> words;
+    words.emplace_root("hello");
+    CHECK(words.get_layout(750).label(0) == "hello");
+
+    Tree<Complex> complexes;
+    complexes.emplace_root(1, 2);
+    CHECK(complexes.get_layout(750).label(0) == "1.0+2.0i");
+}
+
+TEST_CASE("Test Complex Ordering") {
+    Complex a(3, 4), b(-4, 3), c(1, 1);
+    CHECK(a.MagnitudeSquared() == 25);
+    CHECK(a.Magnitude() == 5);
+    CHECK(c < a);
+    CHECK(a > c);
+    CHECK_FALSE(a < b);  // Equal magnitudes: neither is smaller or larger.
+    CHECK_FALSE(a > b);
+    CHECK_FALSE(a > a);
+
+    Tree<Complex> tree;
+    tree.emplace_root(1, 1);
+    tree.emplace_sub_node(Complex(1, 1), 3, 4);
+    tree.emplace_sub_node(Complex(1, 1), 0, 2);
+    tree.emplace_sub_node(Complex(3, 4), 6, 8);
+    vector<double> magnitudes;
+    for (auto node = tree.begin_heap(); node != tree.end_heap(); ++node) magnitudes.push_back(node->get_value().Magnitude());
+    CHECK(magnitudes == vector<double>{10, 5, 2, sqrt(2.0)});  // Largest first.
+}
+
+TEST_CASE("Test Complex Array Kernels") {
+    ComplexArray a, b;
+    for (int i = 0; i < 11; i++) {  // Odd size: covers the vector bodies and the scalar tails.
+        a.push_back(Complex(i - 5, 2 * i + 1));
+        b.push_back(Complex(0.5 * i, -i));
+    }
+
+    vector<SimdLevel> levels = {SimdLevel::SCALAR};
+    if (simd_level() != SimdLevel::SCALAR) levels.push_back(SimdLevel::SSE2);
+    if (simd_level() == SimdLevel::AVX2) levels.push_back(SimdLevel::AVX2);
+    for (SimdLevel level : levels) {
+        vector<double> norms(a.size()), mags(a.size());
+        magnitudes_squared(a, norms.data(), level);
+        magnitudes(a, mags.data(), level);
+        ComplexArray sum, product, shifted, scaled;
+        add(a, b, sum, level);
+        multiply(a, b, product, level);
+        add(a, Complex(1, -1), shifted, level);
+        multiply(a, Complex(0, 2), scaled, level);
+        for (size_t i = 0; i < a.size(); i++) {
+            Complex x = a.get(i), y = b.get(i);
+            CHECK(norms[i] == x.MagnitudeSquared());
+            CHECK(mags[i] == x.Magnitude());
+            CHECK(sum.get(i) == Complex(x.get_real() + y.get_real(), x.get_imag() + y.get_imag()));
+            CHECK(product.get(i) == Complex(x.get_real() * y.get_real() - x.get_imag() * y.get_imag(),
+                                            x.get_real() * y.get_imag() + x.get_imag() * y.get_real()));
+            CHECK(shifted.get(i) == Complex(x.get_real() + 1, x.get_imag() - 1));
+            CHECK(scaled.get(i) == Complex(-2 * x.get_imag(), 2 * x.get_real()));
+        }
+    }
+    ComplexArray shorter(3);
+    CHECK_THROWS_AS(add(a, shorter, shorter), invalid_argument);
+
+    Tree<Complex, 3> tree;
+    tree.emplace_root(1, 1);
+    tree.emplace_sub_node(Complex(1, 1), 3, 4);
+    tree.emplace_sub_node(Complex(1, 1), 0, 2);
+    tree.emplace_sub_node(Complex(3, 4), 6, 8);
+    vector<double> expected;
+    for (auto node = tree.begin_heap(); node != tree.end_heap(); ++node) expected.push_back(node->get_value().Magnitude());
+    vector<double> batched;
+    for (Node<Complex> *node : heap_order(tree)) batched.push_back(node->get_value().Magnitude());
+    CHECK(batched == expected);
+
+    uint64_t version = tree.get_version();
+    transform_values(tree, [](ComplexArray &values) { multiply(values, Complex(2, 0), values); });
+    CHECK(tree.get_root()->get_value() == Complex(2, 2));
+    CHECK(tree.get_root()->get_children()[0]->get_children()[0]->get_value() == Complex(12, 16));
+    CHECK(tree.get_version() != version);  // Cached layouts see the new values.
+}
+
+TEST_CASE("Test Vectorized Find") {
+    vector<SimdLevel> levels = {SimdLevel::SCALAR};
+    if (simd_level() != SimdLevel::SCALAR) levels.push_back(SimdLevel::SSE2);
+    if (simd_level() == SimdLevel::AVX2) levels.push_back(SimdLevel::AVX2);
+    for (SimdLevel level : levels) {
+        for (size_t n : {0, 1, 7, 16, 37}) {  // Matches in vector bodies and scalar tails.
+            vector<int> ints(n);
+            vector<long long> longs(n);
+            vector<float> floats(n);
+            vector<double> doubles(n);
+            vector<short> shorts(n);
+            for (size_t i = 0; i < n; i++) {
+                ints[i] = static_cast<int>(i) - 3;
+                longs[i] = static_cast<long long>(i) << 33;
+                floats[i] = 0.5f * i;
+                doubles[i] = -0.25 * i;
+                shorts[i] = static_cast<short>(i);
+            }
+            for (size_t i = 0; i < n; i++) {
+                CHECK(find_equal(ints.data(), 0, n, ints[i], level) == i);
+                CHECK(find_equal(longs.data(), 0, n, longs[i], level) == i);
+                CHECK(find_equal(floats.data(), 0, n, floats[i], level) == i);
+                CHECK(find_equal(doubles.data(), 0, n, doubles[i], level) == i);
+                CHECK(find_equal(shorts.data(), 0, n, shorts[i], level) == i);
+                CHECK(find_equal(ints.data(), i + 1, n, ints[i], level) == n);  // Search starts at begin.
+            }
+            CHECK(find_equal(ints.data(), 0, n, -100, level) == n);
+            CHECK(find_equal(doubles.data(), 0, n, nan(""), level) == n);  // NaN never compares equal.
+        }
+    }
+
+    Tree<int, 4> tree;  // Values repeat: every node holds its index modulo 10, with room for a fourth child.
+    vector<Node<int> *> nodes = {tree.emplace_root(0)};
+    for (int i = 1; i < 500; i++) nodes.push_back(nodes[(i - 1) / 3]->emplace_child(i % 10));
+    tree.mark_changed();
+
+    CHECK(tree.find_node(7) != nullptr);  // Without the scan, direct node edits are always seen.
+    CHECK(tree.find_node(7) != nullptr);
+    nodes[1]->emplace_child(55);
+    CHECK(tree.find_node(tree.get_root(), 55) != nullptr);
+    CHECK(tree.find_all(55).size() == 1);
+    tree.set_value(nodes[1]->get_children().back(), 5);
+
+    tree.enable_value_scan();
+    CHECK(tree.has_value_scan());
+    vector<Node<int> *> sevens;  // Expected matches, in pre-order.
+    for (auto node = tree.begin_pre_order(); node != tree.end_pre_order(); ++node) {
+        if (node->get_value() == 7) sevens.push_back(&*node);
+    }
+    for (int round = 0; round < 3; round++) {  // The first lookup searches recursively, later ones scan.
+        CHECK(tree.find_node(7) == sevens.front());
+        CHECK(tree.find_node(tree.get_root(), 42) == nullptr);
+    }
+    CHECK(tree.find_all(7) == sevens);
+    CHECK(tree.find_all(42).empty());
+
+    Node<int> *added = tree.emplace_sub_node(4, 42);  // Mutations invalidate the flat copy.
+    CHECK(tree.find_node(42) == added);
+    CHECK(tree.find_node(42) == added);
+    CHECK(tree.find_all(42) == vector<Node<int> *>{added});
+
+    Node<int> *direct = nodes[2]->emplace_child(43);  // Direct edits need mark_changed() while the scan is on.
+    tree.mark_changed();
+    CHECK(tree.find_node(43) == direct);
+    CHECK(tree.find_node(43) == direct);
+    tree.enable_value_scan(false);
+    CHECK(tree.find_all(7) == sevens);
+
+    Tree<string> words;
+    words.emplace_root("a");
+    words.emplace_sub_node("a", "b");
+    words.emplace_sub_node("a", "b");
+    CHECK(words.find_all("b").size() == 2);
+    CHECK(words.find_node("b") == words.get_root()->get_children()[0]);
+}
+
+struct EqualityOnly {  // Has operator== but no operator<, so trees of it must not need the summaries.
+    int id;
+    EqualityOnly(int i) : id(i) {}
+    bool operator==(const EqualityOnly &other) const { return id == other.id; }
+};
+
+TEST_CASE("Test Equality-Only Values") {
+    static_assert(!is_less_comparable<EqualityOnly>::value, "EqualityOnly has no operator<");
+    static_assert(is_less_comparable<int>::value && is_less_comparable<string>::value, "built-in orderings");
+
+    Tree<EqualityOnly, 3> tree;  // Compiling this test is most of the check.
+    tree.add_root(Node<EqualityOnly>(1));
+    tree.add_sub_node(Node<EqualityOnly>(1), Node<EqualityOnly>(2));
+    tree.emplace_sub_node(EqualityOnly(2), 3);
+    Node<EqualityOnly> *found = tree.find_node(EqualityOnly(3));
+    REQUIRE(found != nullptr);
+    CHECK(found->get_parent()->get_value() == EqualityOnly(2));
+    CHECK(tree.find_all(EqualityOnly(4)).empty());
+}
+
+TEST_CASE("Test Subtree Summaries") {
+    Tree<int, 3> tree;
+    tree.enable_summaries();
+    tree.emplace_root(50);
+    for (int branch = 0; branch < 3; branch++) {  // Branch b holds values 100 * (b + 1) and up.
+        int base = 100 * (branch + 1);
+        tree.emplace_sub_node(50, base);
+        for (int i = 1; i < 30; i++) tree.emplace_sub_node(base + (i - 1) / 3, base + i);
+    }
+    Node<int> *root = tree.get_root();
+    CHECK(tree.subtree_range(root).low == 50);
+    CHECK(tree.subtree_range(root).high == 329);
+    CHECK(tree.subtree_range(root->get_children()[1]).low == 200);
+    CHECK(tree.subtree_range(root->get_children()[1]).high == 229);
+
+    Node<int> *found = tree.find_node(217);
+    REQUIRE(found != nullptr);
+    CHECK(found->get_value() == 217);
+    CHECK(tree.find_node(150) == nullptr);
+    CHECK(tree.find_node(root->get_children()[0], 217) == nullptr);  // Searches below the given node only.
+
+    vector<Node<int> *> in_range = tree.find_in_range(225, 305);
+    vector<int> values;
+    for (Node<int> *node : in_range) values.push_back(node->get_value());
+    sort(values.begin(), values.end());  // Values are numbered level by level, so pre-order is not sorted.
+    CHECK(values == vector<int>{225, 226, 227, 228, 229, 300, 301, 302, 303, 304, 305});
+    CHECK(tree.find_in_range(151, 199).empty());
+
+    tree.enable_summaries(false);  // The plain traversal gives the same answers.
+    CHECK(tree.find_in_range(225, 305) == in_range);
+    CHECK(tree.find_node(217) == found);
+    CHECK_THROWS_AS(tree.subtree_range(root), runtime_error);
+
+    tree.enable_summaries();  // Direct edits are picked up by a rebuild.
+    Node<int> *leaf = root->get_children()[2]->get_children()[0]->get_children()[0];
+    leaf->emplace_child(7);
+    tree.mark_changed();
+    CHECK(tree.subtree_range(root).low == 7);
+    CHECK(tree.find_node(7) != nullptr);
+    tree.set_value(leaf, 1000);
+    CHECK(tree.subtree_range(root).high == 1000);
+    CHECK(tree.find_in_range(999, 2000) == vector<Node<int> *>{leaf});
+
+    Tree<Complex> complex_tree;  // Ranges follow Complex::operator<, the magnitude.
+    complex_tree.enable_summaries();
+    complex_tree.emplace_root(3.0, 4.0);
+    complex_tree.emplace_sub_node(Complex(3.0, 4.0), 0.0, 1.0);
+    complex_tree.emplace_sub_node(Complex(3.0, 4.0), 6.0, 8.0);
+    CHECK(complex_tree.subtree_range(complex_tree.get_root()).low == Complex(0.0, 1.0));
+    CHECK(complex_tree.subtree_range(complex_tree.get_root()).high == Complex(6.0, 8.0));
+    CHECK(complex_tree.find_node(Complex(4.0, 3.0)) == nullptr);  // Same magnitude as the root, different value.
+    CHECK(complex_tree.find_in_range(Complex(1.0, 0.0), Complex(5.0, 0.0)).size() == 2);
+}
+
+TEST_CASE("Test Bloom Filters") {
+    BloomFilter filter(100, 10);
+    for (uint64_t i = 0; i < 100; i++) filter.insert(SubtreeBloom<int>::hash_of(static_cast<int>(i)));
+    size_t false_positives = 0;
+    for (uint64_t i = 0; i < 100; i++) CHECK(filter.may_contain(SubtreeBloom<int>::hash_of(static_cast<int>(i))));  // No false negatives.
+    for (int i = 1000; i < 11000; i++) false_positives += filter.may_contain(SubtreeBloom<int>::hash_of(i));
+    CHECK(false_positives < 300);  // About 1% expected.
+
+    Tree<string, 3> tree;
+    tree.enable_bloom_filters(4);
+    tree.emplace_root("root");
+    vector<string> names = {"root"};
+    for (int i = 1; i < 300; i++) {
+        names.push_back("item" + to_string(i));
+        tree.emplace_sub_node(names[(i - 1) / 3], names.back());  // Parents are found through the filters.
+    }
+    for (const string &name : names) {
+        Node<string> *found = tree.find_node(name);
+        REQUIRE(found != nullptr);
+        CHECK(found->get_value() == name);
+    }
+    CHECK(tree.find_node("missing") == nullptr);
+    CHECK(tree.find_node(tree.get_root()->get_children()[0], "item2") == nullptr);  // item2 is in another branch.
+
+    const SubtreeBloom<string> &blooms = tree.get_bloom_filters();
+    CHECK(blooms.get_filters().count(tree.get_root()) == 1);
+    CHECK(blooms.memory_bytes() > 0);
+    for (const auto &entry : blooms.get_filters()) CHECK(entry.first->get_children().size() > 0);  // No leaf has a filter.
+
+    Node<string> *leaf = tree.find_node("item299");
+    leaf->emplace_child("direct");  // Edits outside the tree rebuild the filters.
+    tree.mark_changed();
+    CHECK(tree.find_node("direct") == leaf->get_children()[0]);
+    tree.set_value(leaf, "renamed");
+    CHECK(tree.find_node("item299") == nullptr);
+    CHECK(tree.find_node("renamed") == leaf);
+
+    tree.enable_summaries();  // Both indexes prune together.
+    CHECK(tree.find_node("item150")->get_value() == "item150");
+    tree.disable_bloom_filters();
+    CHECK(tree.find_node("item150")->get_value() == "item150");
+    CHECK_THROWS_AS(tree.get_bloom_filters(), runtime_error);
+    CHECK_THROWS_AS(tree.enable_bloom_filters(1), invalid_argument);
+}
+
+TEST_CASE("Test Subtree Shape") {
+    Tree<int, 3> tree;
+    CHECK(tree.size() == 0);
+    CHECK(tree.height() == 0);
+    tree.enable_shape_tracking();
+    CHECK(tree.size() == 0);
+    mt19937 rng(7);
+    CHECK(tree.random_node(rng) == nullptr);
+    tree.emplace_root(0);
+    for (int i = 1; i < 40; i++) tree.emplace_sub_node((i - 1) / 3, i);  // Levels of 1, 3, 9 and 27 nodes.
+    CHECK(tree.size() == 40);
+    CHECK(tree.height() == 4);
+    Node<int> *root = tree.get_root();
+    CHECK(tree.subtree_size(root) == 40);
+    CHECK(tree.subtree_size(root->get_children()[0]) == 13);  // 1 + 3 + 9.
+    CHECK(tree.subtree_size(root->get_children()[2]) == 13);
+    CHECK(tree.depth(root) == 0);
+    CHECK(tree.depth(tree.find_node(39)) == 3);
+
+    vector<Node<int> *> pre_order;
+    for (auto node = tree.begin_pre_order(); node != tree.end_pre_order(); ++node) pre_order.push_back(&*node);
+    for (size_t i = 0; i < pre_order.size(); i++) CHECK(tree.node_at(i) == pre_order[i]);
+    CHECK_THROWS_AS(tree.node_at(40), out_of_range);
+
+    vector<int> draws(40, 0);
+    for (int i = 0; i < 4000; i++) draws[tree.random_node(rng)->get_value()]++;
+    for (int count : draws) CHECK(count > 40);  // About 100 each.
+
+    Node<int> *leaf = tree.find_node(39);  // Direct edits are picked up by a rebuild.
+    leaf->emplace_child(40)->emplace_child(41);
+    tree.mark_changed();
+    CHECK(tree.size() == 42);
+    CHECK(tree.height() == 6);
+    CHECK(tree.subtree_size(root->get_children()[2]) == 15);
+
+    tree.enable_shape_tracking(false);  // The traversals give the same answers.
+    CHECK(tree.size() == 42);
+    CHECK(tree.height() == 6);
+    CHECK(tree.node_at(41) == pre_order.back()->get_children()[0]->get_children()[0]);
+    CHECK_THROWS_AS(tree.node_at(42), out_of_range);
+    CHECK_THROWS_AS(tree.depth(root), runtime_error);
+
+    tree.enable_shape_tracking();  // Direct edits without mark_changed() fall back to a rebuild instead of throwing.
+    CHECK(tree.size() == 42);
+    Node<int> *quiet = tree.find_node(38)->emplace_child(200);  // The tree is not told.
+    Node<int> *child = nullptr;
+    CHECK_NOTHROW(child = tree.emplace_sub_node(200, 201));
+    CHECK(tree.depth(child) == 5);
+    CHECK(tree.subtree_size(tree.find_node(38)) == 3);
+    CHECK(tree.size() == 44);
+
+    Node<int> *lone = quiet->emplace_child(202);  // Queries about an unknown node rebuild too.
+    CHECK(tree.depth(lone) == 5);
+    Node<int> *tail = tree.find_node(41)->emplace_child(203);  // The last node in pre-order.
+    CHECK(tree.node_at(45) == tail);
+    CHECK_THROWS_AS(tree.node_at(46), out_of_range);
+}
+
+TEST_CASE("Test Interval Index") {
+    Tree<int, 3> tree;
+    vector<Node<int> *> nodes = {tree.emplace_root(0)};
+    for (int i = 1; i < 121; i++) nodes.push_back(nodes[(i - 1) / 3]->emplace_child(i));
+    tree.mark_changed();
+
+    auto below = [&](size_t ancestor, size_t node) {  // Walks the BFS numbering up from node.
+        while (node > ancestor) node = (node - 1) / 3;
+        return node == ancestor;
+    };
+    for (size_t a = 0; a < nodes.size(); a += 7) {
+        for (size_t b = 0; b < nodes.size(); b++) CHECK(tree.is_ancestor(nodes[a], nodes[b]) == below(a, b));
+    }
+    CHECK(tree.descendant_count(nodes[0]) == 120);
+    CHECK(tree.descendant_count(nodes[1]) == 39);
+    CHECK(tree.descendant_count(nodes[120]) == 0);
+
+    vector<Node<int> *> pre_order;
+    for (auto node = tree.begin_pre_order(); node != tree.end_pre_order(); ++node) pre_order.push_back(&*node);
+    const PreOrderIndex<int> &index = tree.get_interval_index();
+    for (size_t i = 0; i < pre_order.size(); i++) CHECK(index.interval(pre_order[i]).entry == i);
+    NodeSpan<int> span = tree.subtree_nodes(nodes[2]);
+    REQUIRE(span.size() == 40);
+    CHECK(*span.begin() == nodes[2]);
+    for (Node<int> *node : span) CHECK(below(2, node->get_value()));
+
+    Node<int> *added = tree.emplace_sub_node(120, 121);  // Changes rebuild the index.
+    CHECK(tree.is_ancestor(nodes[1], added) == below(1, 120));
+    CHECK(tree.descendant_count(nodes[0]) == 121);
+    Node<int> outside(5);
+    CHECK_THROWS_AS(tree.is_ancestor(nodes[0], &outside), out_of_range);
+}
+
+TEST_CASE("Test Lowest Common Ancestor") {
+    Tree<int, 3> tree;
+    Node<int> *root = tree.emplace_root(0);
+    CHECK(tree.lca(root, root) == root);
+    vector<Node<int> *> nodes = {root};
+    for (int i = 1; i < 200; i++) nodes.push_back(nodes[(i - 1) / 3]->emplace_child(i));
+    for (int i = 200; i < 230; i++) nodes.push_back(nodes[i - 1]->emplace_child(i));  // A long path below node 199.
+    tree.mark_changed();
+
+    auto naive = [](size_t a, size_t b) {  // Climbs the BFS numbering, then the path.
+        auto up = [](size_t x) { return x >= 200 ? x - 1 : (x - 1) / 3; };
+        while (a != b) {
+            if (a > b) a = up(a);
+            else b = up(b);
+        }
+        return a;
+    };
+    for (size_t a = 0; a < nodes.size(); a += 3) {
+        for (size_t b = 0; b < nodes.size(); b++) CHECK(tree.lca(nodes[a], nodes[b]) == nodes[naive(a, b)]);
+    }
+    CHECK(tree.lca(nodes[229], nodes[199]) == nodes[199]);  // An ancestor is its own LCA with descendants.
+    CHECK(tree.lca(nodes[4], nodes[4]) == nodes[4]);
+
+    Node<int> *added = tree.emplace_sub_node(67, 500);  // Changes rebuild the table.
+    CHECK(tree.lca(added, nodes[68]) == nodes[22]);
+    CHECK(tree.get_lca_index().size() == 231);
+    Node<int> outside(1);
+    CHECK_THROWS_AS(tree.lca(root, &outside), out_of_range);
+}
+
+TEST_CASE("Test Parent Links") {
+    Tree<int, 3> tree;
+    Node<int> *root = tree.emplace_root(0);
+    CHECK(root->get_parent() == nullptr);
+    Node<int> *a = tree.emplace_sub_node(0, 1);
+    tree.add_sub_node(Node<int>(1), Node<int>(2));  // Copy and move paths.
+    Node<int> child(3);
+    tree.add_sub_node(Node<int>(1), child);
+    Node<int> *b = a->get_children()[0];
+    Node<int> *c = b->emplace_child(4);  // Direct edits set the links too.
+    c->add_child(Node<int>(5));
+    Node<int> *d = c->get_children()[0];
+    tree.mark_changed();
+    CHECK(a->get_parent() == root);
+    CHECK(b->get_parent() == a);
+    CHECK(a->get_children()[1]->get_parent() == a);
+    CHECK(d->get_parent() == c);
+
+    vector<Node<int> *> up;
+    for (Node<int> &node : ancestors(d)) up.push_back(&node);
+    CHECK(up == vector<Node<int> *>{c, b, a, root});
+    CHECK(ancestors(root).begin() == ancestors(root).end());
+
+    auto path = path_from_root(d);
+    CHECK(vector<Node<int> *>(path.begin(), path.end()) == vector<Node<int> *>{root, a, b, c, d});
+    CHECK(path_from_root(root).size() == 1);
+    CHECK(path_from_root<int>(nullptr).size() == 0);
+
+    b->add_child(*c);  // Copies the subtree: the copied grandchild hangs under the copy, not under c.
+    tree.mark_changed();
+    Node<int> *copy = b->get_children().back();
+    REQUIRE(copy != c);
+    REQUIRE(copy->get_children().size() == 1);
+    Node<int> *copied_leaf = copy->get_children()[0];
+    CHECK(copied_leaf != d);
+    CHECK(copied_leaf->get_value() == 5);
+    CHECK(copied_leaf->get_parent() == copy);
+    CHECK(copy->get_parent() == b);
+    auto copied_path = path_from_root(copied_leaf);
+    CHECK(vector<Node<int> *>(copied_path.begin(), copied_path.end()) == vector<Node<int> *>{root, a, b, copy, copied_leaf});
+    CHECK(d->get_parent() == c);  // The source is untouched.
+
+    Node<int> *deep = d;  // Paths longer than the inline buffer spill to the heap.
+    for (int i = 6; i < 106; i++) deep = deep->emplace_child(i);
+    auto long_path = path_from_root(deep);
+    REQUIRE(long_path.size() == 105);
+    CHECK(long_path[0] == root);
+    CHECK(long_path[104] == deep);
+    for (size_t i = 1; i < long_path.size(); i++) CHECK(long_path[i]->get_parent() == long_path[i - 1]);
+
+    stringstream buffer;  // Loading rebuilds the links.
+    tree.mark_changed();
+    tree.save(buffer);
+    Tree<int, 3> loaded;
+    loaded.load(buffer);
+    Node<int> *last = loaded.find_node(105);
+    REQUIRE(last != nullptr);
+    size_t depth = 0;
+    for (Node<int> &node : ancestors(last)) {
+        depth++;
+        if (node.get_parent() == nullptr) CHECK(&node == loaded.get_root());
+    }
+    CHECK(depth == 104);
+}
+
+TEST_CASE("Test Layout Grid") {
+    Tree<int> tree;
+    vector<Node<int> *> nodes = {tree.emplace_root(0)};
+    for (int i = 1; i < 1000; i++) nodes.push_back(nodes[(i - 1) / 2]->emplace_child(i));
+    tree.mark_changed();
+
+    const TreeLayout<int> &layout = tree.get_layout(100000);
+    LayoutGrid grid;
+    grid.update(layout);
+    CHECK(grid.level_count() > 1);
+
+    float x0 = 20000, y0 = 0, x1 = 60000, y1 = 800;  // A window onto part of the tree.
+    vector<bool> reported(layout.size(), false);
+    grid.for_each_node(x0, y0, x1, y1, [&](uint32_t i) { reported[i] = true; });
+    for (size_t i = 0; i < layout.size(); i++) {
+        const LayoutPoint &p = layout.positions[i];
+        if (p.x >= x0 && p.x <= x1 && p.y >= y0 && p.y <= y1) CHECK(reported[i]);  // Nothing visible is culled.
+    }
+    CHECK(count(reported.begin(), reported.end(), true) < static_cast<long>(layout.size()));  // But most is.
+
+    vector<bool> edge_reported(layout.size(), false);
+    grid.for_each_edge(x0, y0, x1, y1, [&](uint32_t child) { edge_reported[child] = true; });
+    for (size_t i = 0; i < layout.size(); i++) {
+        if (layout.parents[i] == NO_PARENT) continue;
+        const LayoutPoint &a = layout.positions[i], &b = layout.positions[layout.parents[i]];
+        bool overlaps = max(a.x, b.x) >= x0 && min(a.x, b.x) <= x1 && max(a.y, b.y) >= y0 && min(a.y, b.y) <= y1;
+        if (overlaps) CHECK(edge_reported[i]);
+    }
+
+    size_t total = 0;
+    grid.for_each_cell(grid.level_count() - 1, -1e9f, -1e9f, 1e9f, 1e9f, [&](const GridCell &cell) { total += cell.count; });
+    CHECK(total == layout.size());  // The coarsest level aggregates every node.
+}
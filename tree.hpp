@@ -1,14 +1,31 @@
 #ifndef TREE_HPP
 #define TREE_HPP
 
+#include <algorithm>
+#include <cstdint>
 #include <iomanip>
+#include "bloom_filter.hpp"
+#include "buffered_stream.hpp"
+#include "interval_index.hpp"
+#include "lca_index.hpp"
 #include "node.hpp"
+#include "node_path.hpp"
+#include "tree_export.hpp"
+#include "tree_layout.hpp"
+#include "subtree_shape.hpp"
+#include "subtree_summary.hpp"
+#include "value_scan.hpp"
 #include <iostream>
+#include <memory>
 #include <queue>
-#include <SFML/Graphics.hpp>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
 using namespace std;
 
-const float NODE_RADIUS = 50.0f;  // Radius for node drawing in SFML.
+const char TREE_FILE_MAGIC[4] = {'E', 'X', '2', 'T'};  // Tag at the start of every saved tree.
+const uint8_t TREE_FILE_VERSION = 1;  // Bumped whenever the binary layout changes.
 
 template<typename T, int K = 2>
 class Tree {
@@ -16,6 +33,20 @@ private:
     Node<T> *root;  // Root node of the tree.
     int k;  // Maximum number of children per node.
     bool is_binary_tree;  // Indicates if the tree is binary.
+    uint64_t version;  // Bumped on every structural change so caches know when to rebuild.
+    TreeLayout<T> layout;  // Cached drawing layout.
+    ValueScan<T> scan;  // Flat copy of the values for vectorized lookups on numeric trees, when enabled.
+    bool scan_enabled;
+    uint64_t last_lookup_version;  // Tree version at the previous root lookup.
+    SubtreeSummary<T> summary;  // Min/max value per subtree, when enabled.
+    bool summaries_enabled;
+    SubtreeBloom<T> blooms;  // Bloom filters of large subtrees, when enabled.
+    bool blooms_enabled;
+    SubtreeShape<T> shapes;  // Subtree size and depth per node, when enabled.
+    bool shapes_enabled;
+    PreOrderIndex<T> intervals;  // Pre-order entry/exit numbers, built on first use.
+    LcaIndex<T> lcas;  // Sparse table for lowest common ancestors, built on first use.
+    vector<Node<T> *> search_path;  // Root-to-node path of the last pruned search.
 
     // Vectors to store nodes during different traversals.
     vector<Node<T> *> pre_order_nodes;
@@ -46,7 +77,7 @@ private:
     void in_order_helper(Node<T> *root, vector<Node<T> *> &inOrderNodes) {
         if (root == nullptr) return;  // Base case: if the current node is null, return.
 
-        auto children = root->get_children();  // Get the children of the current node.
+        const auto &children = root->get_children();  // Get the children of the current node.
         if (children.size() > 0) {  // If there are children, traverse the first child.
             in_order_helper(children[0], inOrderNodes);
         }
@@ -81,13 +112,54 @@ private:
         }
     }
 
+    SubtreeSummary<T> &current_summary() {
+        if (!summary.is_current(version)) summary.rebuild(root, version);  // Changed outside add_sub_node.
+        return summary;
+    }
+
+    SubtreeShape<T> &current_shapes() {
+        if (!shapes.is_current(version)) shapes.rebuild(root, version);
+        return shapes;
+    }
+
+    const NodeShape &shape_of(const Node<T> *node) {
+        SubtreeShape<T> &current = current_shapes();
+        if (!current.contains(node)) current.rebuild(root, version);  // Added directly without mark_changed().
+        return current.shape(node);
+    }
+
+    // First pre-order match below start, skipping subtrees that the summaries or Bloom filters rule out.
+    // Leaves the path to it in search_path.
+    Node<T> *find_pruned(Node<T> *start, const T &value) {
+        if constexpr (is_less_comparable<T>::value) {
+            if (summaries_enabled) current_summary();
+        }
+        uint64_t hash = 0;
+        if constexpr (is_hashable<T>::value) {
+            if (blooms_enabled) {
+                if (!blooms.is_current(version)) blooms.rebuild(root, version);
+                hash = SubtreeBloom<T>::hash_of(value);  // Once per search, not per filter.
+            }
+        }
+        find_pruned_path(start, value, search_path, [&](const Node<T> *node) {
+            if constexpr (is_less_comparable<T>::value) {
+                if (summaries_enabled && !summary.may_contain(node, value)) return false;
+            }
+            if constexpr (is_hashable<T>::value) {
+                if (blooms_enabled && !blooms.may_contain(node, hash)) return false;
+            }
+            return true;
+        });
+        return search_path.empty() ? nullptr : search_path.back();
+    }
+
     void heap_helper(Node<T> *root, vector<Node<T> *> &heapNodes) {
         if (root == nullptr) return; // Base case: if the current node is null, return.
 
         dfs_helper(root, heapNodes); // Use DFS to gather all nodes.
 
-        // Create a max-heap based on node values.
-        auto comp = [](Node<T> *lhs, Node<T> *rhs) {
+        // Create a max-heap based on node values (compared by reference, never copied).
+        auto comp = [](const Node<T> *lhs, const Node<T> *rhs) {
             return lhs->get_value() < rhs->get_value(); // This will make the largest value the root of the heap.
         };
 
@@ -97,7 +169,8 @@ private:
     }
 
 public:
-    Tree() : root(nullptr), is_binary_tree(K == 2) {
+    Tree() : root(nullptr), is_binary_tree(K == 2), version(0), scan_enabled(false), last_lookup_version(UINT64_MAX), summaries_enabled(false),
+             blooms_enabled(false), shapes_enabled(false) {
         k = K;  // Initialize k to the specified maximum number of children.
     }
 
@@ -105,21 +178,70 @@ public:
 
     int get_k() const { return k; }  // Get the maximum number of children per node.
 
+    static constexpr int count_width() { return K <= 255 ? 1 : 4; }  // Bytes per child count in saved trees.
+
     Node<T> *get_root() const { return root; }  // Get the root node of the tree.
 
+    uint64_t get_version() const { return version; }  // Changes whenever the tree is modified.
+
+    void mark_changed() { version++; }  // Call after modifying nodes directly rather than through the tree.
+
+    void set_value(Node<T> *node, T value) {  // Replace a node's value in place; node must belong to this tree.
+        node->value = std::move(value);
+        version++;
+    }
+
     void add_root(const Node<T> &node) {
+        emplace_root(node.get_value());  // Copy the value into a new root node.
+    }
+
+    void add_root(Node<T> &&node) {
+        emplace_root(std::move(node.value));  // Move the value into a new root node.
+    }
+
+    template <typename... Args>
+    Node<T> *emplace_root(Args &&...args) {
         if (root != nullptr) {
             throw runtime_error("The root node already exists.");  // If a root already exists, throw an error.
         }
-        root = new Node<T>(node.get_value());  // Set the root node.
+        root = new Node<T>(in_place, std::forward<Args>(args)...);  // Construct the root value in place.
+        version++;
+        return root;
+    }
+
+    // Makes a new node the root and hangs the old root under it, e.g. when a bulk loader learns the root's parent late.
+    template <typename... Args>
+    Node<T> *emplace_root_above(Args &&...args) {
+        if (root == nullptr) return emplace_root(std::forward<Args>(args)...);
+        Node<T> *old_root = root;
+        root = new Node<T>(in_place, std::forward<Args>(args)...);
+        root->children.push_back(old_root);
+        old_root->parent = root;
+        version++;
+        return root;
     }
 
     void add_sub_node(const Node<T> &parent, const Node<T> &child) {
+        emplace_sub_node(parent.get_value(), child.get_value());  // Copy the child's value under the parent.
+    }
+
+    void add_sub_node(const Node<T> &parent, Node<T> &&child) {
+        emplace_sub_node(parent.get_value(), std::move(child.value));  // Move the child's value under the parent.
+    }
+
+    template <typename... Args>
+    Node<T> *emplace_sub_node(const T &parent_value, Args &&...args) {
         if (root == nullptr) {
             throw runtime_error("Root node not found");  // If the root does not exist, throw an error.
         }
 
-        Node<T> *parent_ptr = find_node(root, parent.get_value());  // Find the parent node in the tree.
+        Node<T> *parent_ptr;
+        if (summaries_enabled || blooms_enabled || shapes_enabled) {
+            if (shapes_enabled) current_shapes();  // Bring them up to date before the insert below.
+            parent_ptr = find_pruned(root, parent_value);  // Keeps the path: its summaries grow below.
+        } else {
+            parent_ptr = find_node(root, parent_value);  // Find the parent node in the tree.
+        }
         if (parent_ptr == nullptr) {
             throw runtime_error("Parent node not found.");  // If the parent node is not found, throw an error.
         }
@@ -128,12 +250,196 @@ public:
             throw runtime_error("Node has reached the maximum number of children");  // Check if the parent can accept more children.
         }
 
-        parent_ptr->add_child(child);  // Add the new child to the parent node.
+        version++;
+        Node<T> *child = parent_ptr->emplace_child(std::forward<Args>(args)...);  // Construct the new child in place under the parent.
+        if constexpr (is_less_comparable<T>::value) {
+            if (summaries_enabled) summary.insert(search_path, child, version);  // O(depth) instead of a rebuild.
+        }
+        if constexpr (is_hashable<T>::value) {
+            if (blooms_enabled) blooms.insert(search_path, child, version);
+        }
+        if (shapes_enabled) shapes.insert(search_path, child, version);
+        return child;
+    }
+
+    // Keeps the min/max value of every subtree, so find_node and find_in_range skip subtrees that cannot match.
+    // Pays off when values cluster by subtree; T needs operator<.
+    void enable_summaries(bool enabled = true) {
+        static_assert(is_less_comparable<T>::value, "Subtree summaries need operator<.");
+        summaries_enabled = enabled;
+        if (!enabled) summary.clear();
+    }
+
+    bool has_summaries() const { return summaries_enabled; }
+
+    // Lets whole-tree find_node and find_all on numeric trees scan a flat pre-order copy of the values with SIMD.
+    // The copy is taken on the second root lookup without a change in between and rebuilt after changes; call
+    // mark_changed() after editing nodes directly, or lookups see the old values. Disabling frees the copy.
+    void enable_value_scan(bool enabled = true) {
+        scan_enabled = enabled;
+        if (!enabled) scan.clear();
+    }
+
+    bool has_value_scan() const { return scan_enabled; }
+
+    // Gives every subtree of at least min_subtree_size nodes a Bloom filter of its values, so find_node skips
+    // subtrees that definitely do not hold the key. Memory is about bits_per_value bits per value per
+    // filtered ancestor; 10 bits give about 1% false positives. T needs std::hash.
+    void enable_bloom_filters(size_t min_subtree_size = 256, double bits_per_value = 10) {
+        static_assert(is_hashable<T>::value, "Bloom filters need std::hash<T>.");
+        blooms.configure(min_subtree_size, bits_per_value);
+        blooms_enabled = true;
+    }
+
+    void disable_bloom_filters() {
+        blooms_enabled = false;
+        blooms.clear();
+    }
+
+    bool has_bloom_filters() const { return blooms_enabled; }
+
+    // The filters as of the current tree version.
+    const SubtreeBloom<T> &get_bloom_filters() {
+        if (!blooms_enabled) throw runtime_error("Bloom filters are not enabled.");
+        if constexpr (is_hashable<T>::value) {
+            if (!blooms.is_current(version)) blooms.rebuild(root, version);
+        }
+        return blooms;
+    }
+
+    // Smallest and largest value under node (inclusive); node must belong to this tree.
+    const ValueRange<T> &subtree_range(const Node<T> *node) {
+        if (!summaries_enabled) throw runtime_error("Subtree summaries are not enabled.");
+        return current_summary().range(node);
+    }
+
+    // Tracks the subtree size and depth of every node, so size(), height(), node_at() and random_node()
+    // answer without visiting the whole tree.
+    void enable_shape_tracking(bool enabled = true) {
+        shapes_enabled = enabled;
+        if (!enabled) shapes.clear();
+    }
+
+    bool has_shape_tracking() const { return shapes_enabled; }
+
+    // Number of nodes: O(1) with shape tracking, a full traversal otherwise.
+    size_t size() {
+        if (shapes_enabled) return current_shapes().size();
+        size_t count = 0;
+        vector<Node<T> *> stack;
+        if (root != nullptr) stack.push_back(root);
+        while (!stack.empty()) {
+            Node<T> *curr = stack.back();
+            stack.pop_back();
+            count++;
+            for (auto child : curr->get_children()) stack.push_back(child);
+        }
+        return count;
+    }
+
+    // Number of levels (1 for a lone root, 0 when empty): O(1) with shape tracking, a full traversal otherwise.
+    size_t height() {
+        if (shapes_enabled) return current_shapes().height();
+        size_t levels = 0;
+        vector<pair<Node<T> *, size_t>> stack;  // (node, level)
+        if (root != nullptr) stack.push_back({root, 1});
+        while (!stack.empty()) {
+            auto [curr, level] = stack.back();
+            stack.pop_back();
+            levels = max(levels, level);
+            for (auto child : curr->get_children()) stack.push_back({child, level + 1});
+        }
+        return levels;
+    }
+
+    // Nodes in node's subtree, itself included; node must belong to this tree.
+    size_t subtree_size(const Node<T> *node) {
+        if (!shapes_enabled) throw runtime_error("Shape tracking is not enabled.");
+        return shape_of(node).size;
+    }
+
+    // Edges between the root and node; node must belong to this tree.
+    size_t depth(const Node<T> *node) {
+        if (!shapes_enabled) throw runtime_error("Shape tracking is not enabled.");
+        return shape_of(node).depth;
+    }
+
+    // The node at position index in pre-order: O(depth * K) with shape tracking, a partial traversal otherwise.
+    Node<T> *node_at(size_t index) {
+        if (shapes_enabled) {
+            Node<T> *found = current_shapes().node_at(root, index);
+            if (found != nullptr) return found;
+            shapes.rebuild(root, version);  // Out of range, or a node was added directly without mark_changed().
+            found = shapes.node_at(root, index);
+            if (found == nullptr) throw out_of_range("Node index out of range.");
+            return found;
+        }
+        vector<Node<T> *> stack;
+        if (root != nullptr) stack.push_back(root);
+        while (!stack.empty()) {
+            Node<T> *curr = stack.back();
+            stack.pop_back();
+            if (index-- == 0) return curr;
+            const auto &children = curr->get_children();
+            for (size_t i = children.size(); i > 0; i--) stack.push_back(children[i - 1]);
+        }
+        throw out_of_range("Node index out of range.");
+    }
+
+    // A node drawn uniformly at random, or nullptr if the tree is empty.
+    template <typename Rng>
+    Node<T> *random_node(Rng &rng) {
+        size_t count = size();
+        if (count == 0) return nullptr;
+        return node_at(uniform_int_distribution<size_t>(0, count - 1)(rng));
+    }
+
+    // Pre-order entry and exit number of every node, rebuilt on the first query after a change.
+    const PreOrderIndex<T> &get_interval_index() {
+        if (!intervals.is_current(version)) intervals.rebuild(root, version);
+        return intervals;
+    }
+
+    // True if node is ancestor or lies below it. O(1) once the index is built; both must belong to this tree.
+    bool is_ancestor(const Node<T> *ancestor, const Node<T> *node) { return get_interval_index().is_ancestor(ancestor, node); }
+
+    size_t descendant_count(const Node<T> *node) { return get_interval_index().descendant_count(node); }  // Nodes strictly below node.
+
+    // node's subtree in pre-order, as a slice of the index. Valid until the tree changes.
+    NodeSpan<T> subtree_nodes(const Node<T> *node) { return get_interval_index().subtree(node); }
+
+    // Sparse table behind lca(), rebuilt on the first query after a change in O(n log n).
+    const LcaIndex<T> &get_lca_index() {
+        if (!lcas.is_current(version)) lcas.rebuild(root, version);
+        return lcas;
+    }
+
+    // Lowest common ancestor of a and b in O(1); both must belong to this tree.
+    Node<T> *lca(const Node<T> *a, const Node<T> *b) { return get_lca_index().lca(a, b); }
+
+    // Numeric trees looked up twice without changing in between get a flat value copy, scanned with SIMD from then on.
+    bool scan_ready() {
+        if (!scan_enabled) return false;
+        if (scan.is_current(version)) return true;
+        if (last_lookup_version != version) {  // Likely building the tree: a plain search is cheaper than copying.
+            last_lookup_version = version;
+            return false;
+        }
+        scan.update(root, version);
+        return true;
     }
 
+    Node<T> *find_node(const T &value) { return find_node(root, value); }  // Search the whole tree.
+
     Node<T> *find_node(Node<T> *node, const T &value) {
         if (node == nullptr) return nullptr;  // Base case: if the current node is null, return nullptr.
 
+        if (summaries_enabled || blooms_enabled) return find_pruned(node, value);  // Skips subtrees that cannot match.
+
+        if constexpr (is_arithmetic<T>::value) {
+            if (node == root && scan_ready()) return scan.find_first(value);  // Same first match in pre-order.
+        }
+
         if (node->get_value() == value) return node;  // If the current node matches the value, return it.
 
         for (auto child : node->get_children()) {  // Iterate over all children of the current node.
@@ -143,13 +449,198 @@ public:
         return nullptr;  // Node not found in this subtree.
     }
 
+    // Every node holding value, in pre-order.
+    vector<Node<T> *> find_all(const T &value) {
+        if constexpr (is_arithmetic<T>::value) {
+            if (scan_enabled) {
+                if (!scan.is_current(version)) scan.update(root, version);  // A full pass either way: keep the copy.
+                return scan.find_all(value);
+            }
+        }
+        vector<Node<T> *> found;
+        vector<Node<T> *> stack;
+        if (root != nullptr) stack.push_back(root);
+        while (!stack.empty()) {
+            Node<T> *curr = stack.back();
+            stack.pop_back();
+            if (curr->get_value() == value) found.push_back(curr);
+            const auto &children = curr->get_children();
+            for (size_t i = children.size(); i > 0; i--) stack.push_back(children[i - 1]);  // Keep pre-order.
+        }
+        return found;
+    }
+
+    // Every node with low <= value <= high, in pre-order.
+    vector<Node<T> *> find_in_range(const T &low, const T &high) {
+        vector<Node<T> *> found;
+        vector<Node<T> *> stack;
+        const SubtreeSummary<T> *ranges = summaries_enabled ? &current_summary() : nullptr;
+        if (root != nullptr) stack.push_back(root);
+        while (!stack.empty()) {
+            Node<T> *curr = stack.back();
+            stack.pop_back();
+            if (ranges != nullptr && !ranges->overlaps(curr, low, high)) continue;  // Skip the whole subtree.
+            if (!(curr->get_value() < low) && !(high < curr->get_value())) found.push_back(curr);
+            const auto &children = curr->get_children();
+            for (size_t i = children.size(); i > 0; i--) stack.push_back(children[i - 1]);
+        }
+        return found;
+    }
+
     void delete_tree(Node<T> *node) {
-        if (node == nullptr) return;  // Base case: if the current node is null, return.
+        vector<Node<T> *> stack;  // Explicit stack, so deep trees cannot overflow the call stack.
+        if (node != nullptr) stack.push_back(node);
+        while (!stack.empty()) {
+            Node<T> *curr = stack.back();
+            stack.pop_back();
+            for (auto child : curr->get_children()) stack.push_back(child);  // Queue the children first.
+            delete curr;  // Delete the current node.
+        }
+    }
+
+    // Writes the tree as: header, pre-order child counts, then the packed values in the same order.
+    void save(ostream &os) const {
+        static_assert(is_trivially_copyable<T>::value || is_same<T, string>::value,
+                      "save() supports trivially copyable values and strings");
+
+        vector<const Node<T> *> order;  // Pre-order node list, gathered without recursion.
+        vector<const Node<T> *> stack;
+        if (root != nullptr) stack.push_back(root);
+        while (!stack.empty()) {
+            const Node<T> *curr = stack.back();
+            stack.pop_back();
+            order.push_back(curr);
+            const auto &children = curr->get_children();
+            for (auto it = children.rbegin(); it != children.rend(); ++it) stack.push_back(*it);  // Keep left-to-right order.
+        }
+
+        BufferedWriter out(os);
+        out.write(TREE_FILE_MAGIC, sizeof(TREE_FILE_MAGIC));
+        out.write_pod(TREE_FILE_VERSION);
+        out.write_pod(static_cast<uint8_t>(count_width()));
+        out.write_pod(static_cast<uint32_t>(is_trivially_copyable<T>::value ? sizeof(T) : 0));
+        out.write_pod(static_cast<uint64_t>(order.size()));
+
+        for (const Node<T> *node : order) {  // Topology section.
+            uint32_t count = static_cast<uint32_t>(node->get_children().size());
+            if (count_width() == 1) out.write_pod(static_cast<uint8_t>(count));
+            else out.write_pod(count);
+        }
+
+        for (const Node<T> *node : order) {  // Value section.
+            if constexpr (is_trivially_copyable<T>::value) {
+                out.write(&node->get_value(), sizeof(T));
+            } else {
+                const string &value = node->get_value();
+                out.write_pod(static_cast<uint64_t>(value.size()));
+                out.write(value.data(), value.size());
+            }
+        }
+        out.flush();
+        if (!os) throw runtime_error("Failed to write the tree.");
+    }
+
+    // Replaces the contents of this tree with a tree previously written by save().
+    void load(istream &is) {
+        static_assert(is_trivially_copyable<T>::value || is_same<T, string>::value,
+                      "load() supports trivially copyable values and strings");
+
+        BufferedReader in(is);  // Reads only the bytes announced below, so data after the tree stays in the stream.
+        in.expect(sizeof(TREE_FILE_MAGIC) + sizeof(uint8_t) * 2 + sizeof(uint32_t) + sizeof(uint64_t));
+        char magic[sizeof(TREE_FILE_MAGIC)];
+        in.read(magic, sizeof(magic));
+        if (memcmp(magic, TREE_FILE_MAGIC, sizeof(magic)) != 0 || in.read_pod<uint8_t>() != TREE_FILE_VERSION) {
+            throw runtime_error("Not a tree file.");
+        }
+        uint8_t width = in.read_pod<uint8_t>();
+        uint32_t value_size = in.read_pod<uint32_t>();
+        if ((width != 1 && width != 4) || value_size != (is_trivially_copyable<T>::value ? sizeof(T) : 0)) {
+            throw runtime_error("Tree file does not match this tree type.");
+        }
+        uint64_t count = in.read_pod<uint64_t>();  // Untrusted: nothing below is sized from it up front.
+        in.expect(saturating_bytes(count, width + (is_trivially_copyable<T>::value ? sizeof(T) : sizeof(uint64_t))));
+
+        vector<uint32_t> child_counts;  // Grows with the counts actually read, so a corrupt count hits the end of the stream.
+        child_counts.reserve(static_cast<size_t>(min<uint64_t>(count, STREAM_CHUNK_SIZE)));
+        uint64_t open_slots = count == 0 ? 0 : 1;  // Child positions announced so far but not yet filled.
+        for (uint64_t i = 0; i < count; i++) {
+            uint32_t children = width == 1 ? in.read_pod<uint8_t>() : in.read_pod<uint32_t>();
+            if (children > static_cast<uint32_t>(K)) {
+                throw runtime_error("Node has reached the maximum number of children");
+            }
+            if (open_slots == 0) throw runtime_error("Corrupt tree topology.");  // No parent left for this node.
+            open_slots = open_slots - 1 + children;
+            child_counts.push_back(children);
+        }
+        if (open_slots != 0) throw runtime_error("Corrupt tree topology.");  // Some parent is missing children.
+
+        Node<T> *loaded = nullptr;
+        vector<pair<Node<T> *, uint32_t>> open;  // Nodes still waiting for children, with how many are left.
+        try {
+            for (uint64_t i = 0; i < count; i++) {
+                Node<T> *node;
+                if constexpr (is_trivially_copyable<T>::value) {
+                    alignas(T) unsigned char raw[sizeof(T)];
+                    in.read(raw, sizeof(T));
+                    const T &value = *reinterpret_cast<const T *>(raw);
+                    node = open.empty() ? (loaded = new Node<T>(in_place, value)) : open.back().first->emplace_child(value);
+                } else {
+                    uint64_t size = in.read_pod<uint64_t>();
+                    in.expect(saturating_bytes(count - i - 1, sizeof(uint64_t), size));  // This value and the later sizes.
+                    string value;
+                    in.read_text(value, size);
+                    node = open.empty() ? (loaded = new Node<T>(in_place, std::move(value)))
+                                        : open.back().first->emplace_child(std::move(value));
+                }
+
+                if (!open.empty() && --open.back().second == 0) open.pop_back();  // The parent is complete.
+                if (child_counts[i] > 0) {
+                    node->reserve_children(child_counts[i]);
+                    open.emplace_back(node, child_counts[i]);
+                }
+            }
+        } catch (...) {
+            delete_tree(loaded);  // Do not leak a partially loaded tree.
+            throw;
+        }
+
+        delete_tree(root);
+        root = loaded;
+        version++;
+    }
+
+    // Positions of all nodes for a drawing area of the given width, recomputed only after the tree changes.
+    const TreeLayout<T> &get_layout(float width) {
+        if (layout.version != version || layout.width != width) {
+            compute_layout<T>(root, width, version, layout);
+        }
+        return layout;
+    }
 
-        for (auto child : node->get_children()) {  // Recursively delete all children of the current node.
-            delete_tree(child);
+    // Writes the tidy layout as SVG without opening a window. width only sets where the root is centered.
+    // The layout takes O(n) memory; it is reused if already cached, otherwise built for this call and freed.
+    void export_svg(ostream &os, float width = 750) const {
+        if (layout.version == version && layout.width == width) {
+            write_svg(layout, os);
+            return;
         }
-        delete node;  // Delete the current node.
+        TreeLayout<T> temporary;  // Not cached: a one-off export should not keep the arrays alive.
+        compute_layout<T>(root, width, version, temporary);
+        write_svg(temporary, os);
+    }
+
+    void write_ascii(ostream &os) const { ::write_ascii<T>(root, os); }  // Indented text, one node per line.
+
+    void write_dot(ostream &os) const { ::write_dot<T>(root, os); }  // Graphviz digraph.
+
+    void write_csv(ostream &os) const { ::write_csv<T>(root, os); }  // id,parent,depth,value per node.
+
+    // Immutable copy of the layout and labels without node pointers, safe to hand to another thread.
+    shared_ptr<const TreeLayout<T>> snapshot(float width) {
+        auto copy = make_shared<TreeLayout<T>>(get_layout(width));
+        copy->nodes.clear();  // The nodes may change or be freed after the snapshot is taken.
+        copy->nodes.shrink_to_fit();
+        return copy;
     }
 
     class iterator {
@@ -245,98 +736,6 @@ public:
 
     iterator begin() { return begin_bfs_scan(); }  // Default traversal is BFS.
     iterator end() { return end_bfs_scan(); }
-
-    friend ostream &operator<<(ostream &os, Tree<T, K> &tree) {
-        Node<T> *root = tree.get_root();
-
-        if (root == nullptr) {
-            os << "Empty Tree" << endl;  // If the tree is empty, print a message.
-            return os;
-        }
-
-        os << "Starting The GUI..." << endl;  // Message indicating GUI launch.
-
-        sf::Font font;
-        if (!font.loadFromFile("arial.ttf")) {
-            cerr << "Failed to load font file 'arial.ttf'" << endl;  // Error if font file is not found.
-            return os;
-        }
-
-        sf::RenderWindow window(sf::VideoMode(750, 650), "EX2");  // Create the SFML window.
-        window.setVerticalSyncEnabled(true);
-
-        while (window.isOpen()) {
-            sf::Event event;
-            while (window.pollEvent(event)) {
-                if (event.type == sf::Event::Closed)
-                    window.close();  // Close the window on event.
-            }
-
-            window.clear(sf::Color::White);
-            tree.drawTree(window, font);  // Draw the tree in the window.
-            window.display();
-        }
-
-        return os;
-    }
-
-    void drawTree(sf::RenderWindow &window, sf::Font &font) {
-        if (this->root == nullptr) return;  // If the tree is empty, do nothing.
-
-        map<Node<T>*, sf::Vector2f> positions;  // Map to store positions of nodes.
-        float start_x = window.getSize().x / 2;
-        float start_y = NODE_RADIUS * 2;
-        calculate_positions(this->root, positions, start_x, start_y, window.getSize().x / 4);
-
-        for (auto &entry : positions) {  // Draw all nodes.
-            draw_node(window, entry.first, entry.second, font, positions);
-        }
-    }
-
-    void calculate_positions(Node<T> *node, map<Node<T>*, sf::Vector2f> &positions, float x, float y, float horizontal_spacing) {
-        if (node == nullptr) return;  // Base case: if the current node is null, return.
-
-        positions[node] = sf::Vector2f(x, y);  // Store the position of the current node.
-        float child_x = x - ((node->get_children().size() - 1) * horizontal_spacing / 2);
-        float child_y = y + NODE_RADIUS * 3;
-
-        for (auto child : node->get_children()) {  // Recursively calculate positions for all children.
-            calculate_positions(child, positions, child_x, child_y, horizontal_spacing / 2);
-            child_x += horizontal_spacing;
-        }
-    }
-
-    void draw_node(sf::RenderWindow &window, Node<T> *node, sf::Vector2f position, sf::Font &font, const map<Node<T>*, sf::Vector2f> &positions) {
-        sf::CircleShape circle(NODE_RADIUS);
-        circle.setFillColor(sf::Color(48, 155, 141));  // Set the color of the node.
-        circle.setOrigin(NODE_RADIUS, NODE_RADIUS);
-        circle.setPosition(position);
-
-        sf::Text text;
-        text.setFont(font);
-        if constexpr (is_same<T, string>::value) {
-            text.setString(node->get_value());  // If the value is a string, set it directly.
-        } else {
-            ostringstream oss;
-            oss << fixed << setprecision(1) << node->get_value();  // Format the value for display.
-            text.setString(oss.str());
-        }
-        text.setCharacterSize(20);
-        text.setFillColor(sf::Color::Black);  // Set the text color to black.
-        text.setOrigin(text.getLocalBounds().width / 2, text.getLocalBounds().height / 2);
-        text.setPosition(position);
-
-        window.draw(circle);  // Draw the node circle.
-        window.draw(text);  // Draw the node value.
-
-        for (auto child : node->get_children()) {  // Draw lines to all children.
-            sf::Vertex line[] = {
-                sf::Vertex(position),
-                sf::Vertex(positions.at(child))
-            };
-            window.draw(line, 2, sf::Lines);
-        }
-    }
 };
 
 #endif // TREE_HPP
@@ -0,0 +1,130 @@
+#ifndef TREE_BUILDER_HPP
+#define TREE_BUILDER_HPP
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "tree.hpp"
+using namespace std;
+
+/*
+ * Bulk loader that attaches "parent -> child" edges in O(1) each instead of searching from the root.
+ *
+ * Nodes are indexed by value. For nodes already in the tree the first one in pre-order wins, like find_node;
+ * an added child must not repeat a value already in the tree, so every edge resolves its parent the same way
+ * add_sub_node would. Edges may arrive in any order: a child whose parent is not in the tree yet waits until
+ * the parent shows up. In an empty tree the first edge's parent is only a provisional root; an edge that
+ * gives it a parent puts the new node above it, so the root ends up being the one parent that is nobody's child.
+ */
+template <typename T, int K = 2>
+class TreeBuilder {
+private:
+    Tree<T, K> &tree;  // Tree being filled.
+    unordered_map<T, Node<T> *> index;  // Value -> first node holding it in pre-order.
+    unordered_map<T, vector<T>> pending;  // Parent value -> children waiting for that parent.
+    unordered_map<T, T> pending_parent;  // Waiting child value -> its parent value.
+    size_t pending_count;  // Total number of waiting children.
+    bool provisional_root;  // The builder created the root, so a later edge may still give it a parent.
+
+    Node<T> *attach(Node<T> *parent, T &&value) {
+        if (parent->get_children().size() >= static_cast<size_t>(K)) {
+            throw runtime_error("Node has reached the maximum number of children");
+        }
+        if (index.count(value) > 0) {
+            throw runtime_error("Duplicate node value.");  // Later edges could not tell the two nodes apart.
+        }
+        Node<T> *child = parent->emplace_child(std::move(value));
+        index.emplace(child->get_value(), child);
+        tree.mark_changed();
+        return child;
+    }
+
+    // Attaches every child that was waiting for node, then their waiting children, and so on.
+    void adopt_pending(Node<T> *node) {
+        vector<Node<T> *> work = {node};
+        while (!work.empty() && pending_count > 0) {
+            Node<T> *curr = work.back();
+            work.pop_back();
+            auto waiting = pending.find(curr->get_value());
+            if (waiting == pending.end()) continue;
+            vector<T> children = std::move(waiting->second);
+            pending.erase(waiting);
+            pending_count -= children.size();
+            for (T &child : children) {
+                pending_parent.erase(child);
+                work.push_back(attach(curr, std::move(child)));
+            }
+        }
+    }
+
+    // The root turned out to have a parent: puts that parent above it, then its own waiting parent, and so on.
+    void raise_root(const T &parent) {
+        if (index.count(parent) > 0) throw runtime_error("Edge list has no root.");  // The edge closes a cycle.
+        Node<T> *root = tree.emplace_root_above(parent);
+        index.emplace(root->get_value(), root);
+        for (auto above = pending_parent.find(root->get_value()); above != pending_parent.end();
+             above = pending_parent.find(root->get_value())) {
+            T grandparent = std::move(above->second);
+            pending_parent.erase(above);
+            vector<T> &siblings = pending[grandparent];  // Drop the edge to the old root; its siblings still wait.
+            siblings.erase(find(siblings.begin(), siblings.end(), root->get_value()));
+            if (siblings.empty()) pending.erase(grandparent);
+            pending_count--;
+            if (index.count(grandparent) > 0) throw runtime_error("Edge list has no root.");
+            root = tree.emplace_root_above(std::move(grandparent));
+            index.emplace(root->get_value(), root);
+        }
+        adopt_pending(root);  // Children that were waiting for any of the new ancestors.
+    }
+
+public:
+    explicit TreeBuilder(Tree<T, K> &target) : tree(target), pending_count(0), provisional_root(false) {
+        vector<Node<T> *> stack;  // Index whatever the tree already holds, in pre-order so the first match wins.
+        if (tree.get_root() != nullptr) stack.push_back(tree.get_root());
+        while (!stack.empty()) {
+            Node<T> *curr = stack.back();
+            stack.pop_back();
+            index.emplace(curr->get_value(), curr);
+            const auto &children = curr->get_children();
+            for (auto it = children.rbegin(); it != children.rend(); ++it) stack.push_back(*it);
+        }
+    }
+
+    void reserve(size_t count) { index.reserve(count); }  // Pre-size the value index.
+
+    // Adds child under the node holding parent. The first edge into an empty tree also creates a provisional
+    // root. Throws if child repeats a value already in the tree.
+    void add_edge(const T &parent, T child) {
+        if (tree.get_root() == nullptr) {
+            Node<T> *root = tree.emplace_root(parent);
+            index.emplace(root->get_value(), root);
+            provisional_root = true;
+        }
+        if (provisional_root && child == tree.get_root()->get_value()) {
+            raise_root(parent);  // The edge into the root: the parent becomes the new root.
+            return;
+        }
+
+        auto found = index.find(parent);
+        if (found == index.end()) {
+            if (!pending_parent.emplace(child, parent).second) throw runtime_error("Duplicate node value.");
+            pending[parent].push_back(std::move(child));  // Parent not seen yet.
+            pending_count++;
+            return;
+        }
+        Node<T> *node = attach(found->second, std::move(child));
+        if (pending_count > 0) adopt_pending(node);
+    }
+
+    size_t waiting() const { return pending_count; }  // Children still waiting for their parent.
+
+    // Throws if any edge never found its parent. For an empty tree that means the edges had several roots.
+    void finish() const {
+        if (pending_count == 0) return;
+        throw runtime_error(provisional_root ? "Edge list has more than one root." : "Parent node not found.");
+    }
+};
+
+#endif // TREE_BUILDER_HPP
@@ -0,0 +1,234 @@
+#ifndef TREE_EXPORT_HPP
+#define TREE_EXPORT_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "buffered_stream.hpp"
+#include "node.hpp"
+#include "tree_layout.hpp"
+#include "value_format.hpp"
+using namespace std;
+
+const float SVG_MARGIN = NODE_RADIUS * 2;  // Blank border around the drawing.
+const char *const SVG_NODE_FILL = "rgb(48,155,141)";  // Same color as the GUI's node circles.
+const int SVG_LABEL_SIZE = 20;  // Font size of the node labels.
+
+// Writes text with the characters XML reserves replaced by entities.
+inline void write_xml_escaped(BufferedWriter &out, string_view text) {
+    size_t start = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        const char *entity = nullptr;
+        switch (text[i]) {
+            case '&': entity = "&amp;"; break;
+            case '<': entity = "&lt;"; break;
+            case '>': entity = "&gt;"; break;
+            case '"': entity = "&quot;"; break;
+            default: continue;
+        }
+        out.write_text(text.substr(start, i - start));
+        out.write_text(entity);
+        start = i + 1;
+    }
+    out.write_text(text.substr(start));
+}
+
+/*
+ * Writes a layout as an SVG document: every edge as a line, then every node as a circle with its label.
+ *
+ * Output is streamed node by node through a BufferedWriter with to_chars number formatting, so writing
+ * allocates nothing beyond the writer's buffer and never opens a window. The layout itself is O(n).
+ */
+template <typename T>
+void write_svg(const TreeLayout<T> &layout, ostream &os) {
+    BufferedWriter out(os);
+    float x0 = 0, y0 = 0, x1 = 0, y1 = 0;  // Bounds of the node centers.
+    for (size_t i = 0; i < layout.size(); i++) {
+        const LayoutPoint &p = layout.positions[i];
+        x0 = i == 0 ? p.x : min(x0, p.x);
+        y0 = i == 0 ? p.y : min(y0, p.y);
+        x1 = i == 0 ? p.x : max(x1, p.x);
+        y1 = i == 0 ? p.y : max(y1, p.y);
+    }
+    x0 -= SVG_MARGIN;
+    y0 -= SVG_MARGIN;
+    float w = x1 - x0 + SVG_MARGIN, h = y1 - y0 + SVG_MARGIN;
+
+    out.write_text("<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"");
+    out.write_number(x0);
+    out.write_text(" ");
+    out.write_number(y0);
+    out.write_text(" ");
+    out.write_number(w);
+    out.write_text(" ");
+    out.write_number(h);
+    out.write_text("\" width=\"");
+    out.write_number(w);
+    out.write_text("\" height=\"");
+    out.write_number(h);
+    out.write_text("\">\n<g stroke=\"black\" stroke-width=\"2\">\n");
+
+    for (size_t i = 0; i < layout.size(); i++) {  // Edges first, so the circles cover their ends.
+        if (layout.parents[i] == NO_PARENT) continue;
+        const LayoutPoint &a = layout.positions[layout.parents[i]], &b = layout.positions[i];
+        out.write_text("<line x1=\"");
+        out.write_number(a.x);
+        out.write_text("\" y1=\"");
+        out.write_number(a.y);
+        out.write_text("\" x2=\"");
+        out.write_number(b.x);
+        out.write_text("\" y2=\"");
+        out.write_number(b.y);
+        out.write_text("\"/>\n");
+    }
+
+    out.write_text("</g>\n<g font-family=\"Arial\" font-size=\"");
+    out.write_number(SVG_LABEL_SIZE);
+    out.write_text("\" text-anchor=\"middle\" dominant-baseline=\"central\">\n");
+    for (size_t i = 0; i < layout.size(); i++) {
+        const LayoutPoint &p = layout.positions[i];
+        out.write_text("<circle cx=\"");
+        out.write_number(p.x);
+        out.write_text("\" cy=\"");
+        out.write_number(p.y);
+        out.write_text("\" r=\"");
+        out.write_number(NODE_RADIUS);
+        out.write_text("\" fill=\"");
+        out.write_text(SVG_NODE_FILL);
+        out.write_text("\"/><text x=\"");
+        out.write_number(p.x);
+        out.write_text("\" y=\"");
+        out.write_number(p.y);
+        out.write_text("\">");
+        write_xml_escaped(out, layout.label(i));
+        out.write_text("</text>\n");
+    }
+    out.write_text("</g>\n</svg>\n");
+}
+
+// Writes a label inside a double-quoted string, escaping quotes and backslashes (DOT) or doubling quotes (CSV).
+inline void write_quoted(BufferedWriter &out, string_view text, bool csv) {
+    out.write_text("\"");
+    size_t start = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] != '"' && (csv || text[i] != '\\')) continue;
+        out.write_text(text.substr(start, i - start));
+        out.write_text(csv ? "\"" : "\\");  // Then the character itself.
+        start = i;
+    }
+    out.write_text(text.substr(start));
+    out.write_text("\"");
+}
+
+/*
+ * Writes the tree as indented text, one node per line:
+ *
+ *   1
+ *   +-- 2
+ *   |   `-- 4
+ *   `-- 3
+ */
+template <typename T>
+void write_ascii(const Node<T> *root, ostream &os) {
+    BufferedWriter out(os);
+    vector<char> label;  // Scratch buffer reused for every value.
+    vector<char> prefix;  // Bars and spaces for the ancestors of the current node.
+    struct Entry {
+        const Node<T> *node;
+        uint32_t depth;
+        bool last;  // Last child of its parent.
+    };
+    vector<Entry> stack;
+    if (root != nullptr) stack.push_back({root, 0, true});
+    while (!stack.empty()) {
+        Entry entry = stack.back();
+        stack.pop_back();
+        if (entry.depth > 0) {
+            prefix.resize((entry.depth - 1) * 4);
+            out.write(prefix.data(), prefix.size());
+            out.write_text(entry.last ? "`-- " : "+-- ");
+            const char *bar = entry.last ? "    " : "|   ";  // What this node's children see at its depth.
+            prefix.insert(prefix.end(), bar, bar + 4);
+        }
+        label.clear();
+        append_exact(label, entry.node->get_value());
+        out.write(label.data(), label.size());
+        out.write_text("\n");
+
+        const auto &children = entry.node->get_children();
+        for (size_t i = children.size(); i > 0; i--) stack.push_back({children[i - 1], entry.depth + 1, i == children.size()});
+    }
+}
+
+// Writes the tree as a Graphviz digraph; nodes are named n0, n1, ... in pre-order and labeled with their values.
+template <typename T>
+void write_dot(const Node<T> *root, ostream &os) {
+    BufferedWriter out(os);
+    vector<char> label;
+    vector<pair<const Node<T> *, uint64_t>> stack;  // Node and its parent's id.
+    if (root != nullptr) stack.push_back({root, UINT64_MAX});
+    uint64_t next_id = 0;
+    out.write_text("digraph tree {\n");
+    while (!stack.empty()) {
+        auto [node, parent] = stack.back();
+        stack.pop_back();
+        uint64_t id = next_id++;
+        label.clear();
+        append_exact(label, node->get_value());
+        out.write_text("  n");
+        out.write_number(id);
+        out.write_text(" [label=");
+        write_quoted(out, string_view(label.data(), label.size()), false);
+        out.write_text("];\n");
+        if (parent != UINT64_MAX) {
+            out.write_text("  n");
+            out.write_number(parent);
+            out.write_text(" -> n");
+            out.write_number(id);
+            out.write_text(";\n");
+        }
+
+        const auto &children = node->get_children();
+        for (size_t i = children.size(); i > 0; i--) stack.push_back({children[i - 1], id});
+    }
+    out.write_text("}\n");
+}
+
+// Writes one CSV line per node in pre-order: id, parent id (empty for the root), depth and the quoted value.
+template <typename T>
+void write_csv(const Node<T> *root, ostream &os) {
+    BufferedWriter out(os);
+    vector<char> label;
+    struct Entry {
+        const Node<T> *node;
+        uint64_t parent;
+        uint32_t depth;
+    };
+    vector<Entry> stack;
+    if (root != nullptr) stack.push_back({root, UINT64_MAX, 0});
+    uint64_t next_id = 0;
+    out.write_text("id,parent,depth,value\n");
+    while (!stack.empty()) {
+        Entry entry = stack.back();
+        stack.pop_back();
+        uint64_t id = next_id++;
+        out.write_number(id);
+        out.write_text(",");
+        if (entry.parent != UINT64_MAX) out.write_number(entry.parent);
+        out.write_text(",");
+        out.write_number(entry.depth);
+        out.write_text(",");
+        label.clear();
+        append_exact(label, entry.node->get_value());
+        write_quoted(out, string_view(label.data(), label.size()), true);
+        out.write_text("\n");
+
+        const auto &children = entry.node->get_children();
+        for (size_t i = children.size(); i > 0; i--) stack.push_back({children[i - 1], id, entry.depth + 1});
+    }
+}
+
+#endif // TREE_EXPORT_HPP
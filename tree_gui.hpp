@@ -0,0 +1,103 @@
+#ifndef TREE_GUI_HPP
+#define TREE_GUI_HPP
+
+#include <iostream>
+#include <mutex>
+#include <SFML/Graphics.hpp>
+#include "font_cache.hpp"
+#include "tree.hpp"
+#include "tree_layout.hpp"
+#include "tree_renderer.hpp"
+using namespace std;
+
+/*
+ * SFML visualization for Tree. Kept out of tree.hpp so code that only builds and traverses trees does not
+ * parse or link SFML; include this header (and link sfml-graphics) to get `cout << tree`.
+ */
+
+// Applies one window event. Returns true if the window must be redrawn.
+template <typename T, int K>
+bool process_event(Tree<T, K> &tree, const sf::Event &event, sf::RenderWindow &window, ViewNavigator &navigator) {
+    switch (event.type) {
+        case sf::Event::Closed:
+            window.close();  // Close the window on event.
+            return false;
+        case sf::Event::GainedFocus:
+        case sf::Event::MouseEntered:
+            return true;  // The window may have been covered: repaint it.
+        default:
+            return navigator.handle(event, window, tree.get_layout(static_cast<float>(window.getSize().x)));
+    }
+}
+
+template <typename T, int K>
+void drawTree(Tree<T, K> &tree, TreeRenderer<T> &renderer, sf::RenderWindow &window, const sf::Font &font) {
+    if (tree.get_root() == nullptr) return;  // If the tree is empty, do nothing.
+
+    const TreeLayout<T> &positions = tree.get_layout(static_cast<float>(window.getSize().x));
+    renderer.update(positions, font);  // Rebuilds the batches only after a layout change.
+    renderer.draw(window);  // Visible edges, circles and labels in three draw calls.
+}
+
+// Shows the tree in a window until it is closed. The caller is blocked and Tree is not thread-safe, so the
+// window shows the tree as it was when opened; use TreeViewer to watch a tree that keeps changing.
+template <typename T, int K>
+ostream &operator<<(ostream &os, Tree<T, K> &tree) {
+    Node<T> *root = tree.get_root();
+
+    if (root == nullptr) {
+        os << "Empty Tree" << endl;  // If the tree is empty, print a message.
+        return os;
+    }
+
+    os << "Starting The GUI..." << endl;  // Message indicating GUI launch.
+
+    SharedFont &labels = shared_font();  // Parsed once per process, embedded in the binary if built that way.
+    if (!labels.loaded) return os;  // The cache already reported the missing font.
+
+    sf::RenderWindow window(sf::VideoMode(750, 650), "EX2");  // Create the SFML window.
+    window.setVerticalSyncEnabled(true);
+
+    ViewNavigator navigator(window);  // Pan with the mouse or arrows, zoom with the wheel or +/-, Home fits the tree.
+    navigator.fit_if_outside(tree.get_layout(static_cast<float>(window.getSize().x)), window);
+    TreeRenderer<T> renderer;  // Vertex batches built from the layout.
+    RenderStats stats;  // Frames drawn and skipped in this window.
+    sf::Clock layout_clock;
+    long long layout_us = 0;  // Total time spent obtaining the layout.
+    bool dirty = true;  // The first frame is always drawn.
+    sf::Event event;
+    while (window.isOpen()) {
+        if (!dirty) {
+            if (!window.waitEvent(event)) break;  // Sleep until the next input or window event.
+            dirty |= process_event(tree, event, window, navigator);
+            while (window.isOpen() && window.pollEvent(event)) dirty |= process_event(tree, event, window, navigator);
+            if (!window.isOpen()) break;
+        }
+        if (!dirty) {
+            stats.skipped++;  // E.g. mouse moves without dragging: keep the frame on screen.
+            continue;
+        }
+
+        layout_clock.restart();
+        tree.get_layout(static_cast<float>(window.getSize().x));  // Only does work after a change.
+        layout_us += layout_clock.getElapsedTime().asMicroseconds();
+
+        window.setView(navigator.get_view());
+        window.clear(sf::Color::White);
+        {
+            lock_guard<mutex> guard(labels.lock);  // Other viewer threads may use the same font.
+            drawTree(tree, renderer, window, labels.font);  // Draw the tree in the window.
+        }
+        window.display();
+        stats.rendered++;
+        dirty = false;
+    }
+
+    if (stats.rendered > 0) {
+        os << "Layout time per frame: " << static_cast<double>(layout_us) / stats.rendered << " us over " << stats.rendered << " frames" << endl;
+    }
+    os << "Frames rendered: " << stats.rendered << ", skipped: " << stats.skipped << endl;
+    return os;
+}
+
+#endif // TREE_GUI_HPP
@@ -0,0 +1,196 @@
+#ifndef TREE_LAYOUT_HPP
+#define TREE_LAYOUT_HPP
+
+#include <cstdint>
+#include <utility>
+#include <string_view>
+#include <vector>
+#include "node.hpp"
+#include "value_format.hpp"
+using namespace std;
+
+const float NODE_RADIUS = 50.0f;  // Radius for node drawing.
+const float NODE_DISTANCE = NODE_RADIUS * 2.5f;  // Minimum distance between neighboring node centers on a level.
+const uint32_t NO_PARENT = UINT32_MAX;  // Parent index of the root in a layout.
+
+struct LayoutPoint {
+    float x;
+    float y;
+};
+
+// Node positions computed once and reused until the tree or the target width changes.
+template <typename T>
+struct TreeLayout {
+    vector<const Node<T> *> nodes;  // Nodes in pre-order; every other array is indexed the same way. Empty in snapshots.
+    vector<uint32_t> parents;  // Index of each node's parent, NO_PARENT for the root.
+    vector<LayoutPoint> positions;  // Center of each node.
+    vector<char> label_text;  // Every node's formatted value, back to back.
+    vector<uint32_t> label_offsets;  // Label i is label_text[label_offsets[i], label_offsets[i + 1]).
+    uint64_t version = UINT64_MAX;  // Tree version the layout was computed for.
+    float width = -1;  // Width the layout was computed for.
+
+    size_t size() const { return positions.size(); }
+
+    string_view label(size_t i) const {
+        return string_view(label_text.data() + label_offsets[i], label_offsets[i + 1] - label_offsets[i]);
+    }
+};
+
+/*
+ * Tidy tree layout (Walker's algorithm with Buchheim, Juenger and Leipert's linear-time fixes), for any K.
+ *
+ * Every level sits NODE_RADIUS * 3 below its parent, siblings and neighboring subtrees stay at least
+ * NODE_DISTANCE apart, parents are centered over their children and identical subtrees are drawn the same.
+ * Both walks are iterative so deep trees cannot overflow the stack; all state lives in flat arrays indexed
+ * by pre-order position. The root is centered at width / 2.
+ */
+template <typename T>
+void compute_layout(const Node<T> *root, float width, uint64_t version, TreeLayout<T> &layout) {
+    layout.nodes.clear();
+    layout.parents.clear();
+    layout.positions.clear();
+    layout.label_text.clear();
+    layout.label_offsets.assign(1, 0);
+    layout.version = version;
+    layout.width = width;
+    if (root == nullptr) return;
+
+    // Pre-order pass: node list, parents, depths and labels.
+    vector<uint32_t> depth;
+    vector<pair<const Node<T> *, uint32_t>> stack = {{root, NO_PARENT}};
+    while (!stack.empty()) {
+        auto [node, parent] = stack.back();
+        stack.pop_back();
+        uint32_t index = static_cast<uint32_t>(layout.nodes.size());
+        layout.nodes.push_back(node);
+        layout.parents.push_back(parent);
+        depth.push_back(parent == NO_PARENT ? 0 : depth[parent] + 1);
+        append_label(layout.label_text, node->get_value());  // Formatted once per layout, not per frame.
+        layout.label_offsets.push_back(static_cast<uint32_t>(layout.label_text.size()));
+
+        const auto &children = node->get_children();
+        for (size_t i = children.size(); i > 0; i--) stack.push_back({children[i - 1], index});  // Pop left to right.
+    }
+
+    const uint32_t n = static_cast<uint32_t>(layout.nodes.size());
+    const uint32_t NONE = NO_PARENT;
+
+    // Children of every node as consecutive ranges of child_list (pre-order keeps them left to right).
+    vector<uint32_t> child_start(n + 1, 0), child_list(n > 0 ? n - 1 : 0), number(n, 0);
+    for (uint32_t v = 1; v < n; v++) child_start[layout.parents[v] + 1]++;
+    for (uint32_t v = 0; v < n; v++) child_start[v + 1] += child_start[v];
+    vector<uint32_t> fill(child_start.begin(), child_start.end() - 1);
+    for (uint32_t v = 1; v < n; v++) {
+        uint32_t p = layout.parents[v];
+        number[v] = fill[p] - child_start[p];  // Position among its siblings.
+        child_list[fill[p]++] = v;
+    }
+    auto child_count = [&](uint32_t v) { return child_start[v + 1] - child_start[v]; };
+    auto leftmost = [&](uint32_t v) { return child_count(v) > 0 ? child_list[child_start[v]] : NONE; };
+    auto rightmost = [&](uint32_t v) { return child_count(v) > 0 ? child_list[child_start[v + 1] - 1] : NONE; };
+    auto left_sibling = [&](uint32_t v) {
+        return v == 0 || number[v] == 0 ? NONE : child_list[child_start[layout.parents[v]] + number[v] - 1];
+    };
+    auto leftmost_sibling = [&](uint32_t v) { return v == 0 ? v : child_list[child_start[layout.parents[v]]]; };
+
+    vector<double> prelim(n, 0), mod(n, 0), change(n, 0), shift(n, 0);
+    vector<uint32_t> thread(n, NONE), ancestor(n);
+    for (uint32_t v = 0; v < n; v++) ancestor[v] = v;
+    auto next_left = [&](uint32_t v) { return child_count(v) > 0 ? leftmost(v) : thread[v]; };
+    auto next_right = [&](uint32_t v) { return child_count(v) > 0 ? rightmost(v) : thread[v]; };
+
+    auto move_subtree = [&](uint32_t wm, uint32_t wp, double amount) {
+        double subtrees = static_cast<double>(number[wp]) - number[wm];
+        change[wp] -= amount / subtrees;
+        shift[wp] += amount;
+        change[wm] += amount / subtrees;
+        prelim[wp] += amount;
+        mod[wp] += amount;
+    };
+
+    // Pushes v's subtree right until it clears the subtrees of its left siblings.
+    auto apportion = [&](uint32_t v, uint32_t default_ancestor) {
+        uint32_t w = left_sibling(v);
+        if (w == NONE) return default_ancestor;
+        uint32_t vip = v, vop = v, vim = w, vom = leftmost_sibling(v);
+        double sip = mod[vip], sop = mod[vop], sim = mod[vim], som = mod[vom];
+        while (next_right(vim) != NONE && next_left(vip) != NONE) {
+            vim = next_right(vim);
+            vip = next_left(vip);
+            vom = next_left(vom);
+            vop = next_right(vop);
+            ancestor[vop] = v;
+            double amount = (prelim[vim] + sim) - (prelim[vip] + sip) + NODE_DISTANCE;
+            if (amount > 0) {
+                uint32_t a = layout.parents[ancestor[vim]] == layout.parents[v] ? ancestor[vim] : default_ancestor;
+                move_subtree(a, v, amount);
+                sip += amount;
+                sop += amount;
+            }
+            sim += mod[vim];
+            sip += mod[vip];
+            som += mod[vom];
+            sop += mod[vop];
+        }
+        if (next_right(vim) != NONE && next_right(vop) == NONE) {
+            thread[vop] = next_right(vim);
+            mod[vop] += sim - sop;
+        }
+        if (next_left(vip) != NONE && next_left(vom) == NONE) {
+            thread[vom] = next_left(vip);
+            mod[vom] += sip - som;
+            default_ancestor = v;
+        }
+        return default_ancestor;
+    };
+
+    // First walk, post-order: preliminary x relative to the parent, plus modifiers for whole subtrees.
+    struct Frame {
+        uint32_t node, next_child, default_ancestor;
+    };
+    vector<Frame> frames = {{0, 0, leftmost(0)}};
+    while (!frames.empty()) {
+        Frame &f = frames.back();
+        uint32_t v = f.node;
+        if (f.next_child < child_count(v)) {
+            uint32_t child = child_list[child_start[v] + f.next_child++];
+            frames.push_back({child, 0, leftmost(child)});
+            continue;
+        }
+
+        if (child_count(v) > 0) {  // Spread the accumulated shifts over the children.
+            double total_shift = 0, total_change = 0;
+            for (uint32_t c = child_start[v + 1]; c > child_start[v]; c--) {
+                uint32_t w = child_list[c - 1];
+                prelim[w] += total_shift;
+                mod[w] += total_shift;
+                total_change += change[w];
+                total_shift += shift[w] + total_change;
+            }
+        }
+        double midpoint = child_count(v) > 0 ? (prelim[leftmost(v)] + prelim[rightmost(v)]) / 2 : 0;
+        uint32_t w = left_sibling(v);
+        if (w != NONE) {
+            prelim[v] = prelim[w] + NODE_DISTANCE;
+            mod[v] = prelim[v] - midpoint;
+        } else {
+            prelim[v] = midpoint;
+        }
+
+        frames.pop_back();
+        if (!frames.empty()) frames.back().default_ancestor = apportion(v, frames.back().default_ancestor);
+    }
+
+    // Second walk, pre-order: every node's modifier sum is its parent's plus the parent's own modifier.
+    vector<double> mod_sum(n, 0);
+    layout.positions.resize(n);
+    for (uint32_t v = 0; v < n; v++) {
+        uint32_t p = layout.parents[v];
+        if (p != NONE) mod_sum[v] = mod_sum[p] + mod[p];
+        layout.positions[v] = {static_cast<float>(prelim[v] + mod_sum[v]), NODE_RADIUS * 2 + depth[v] * NODE_RADIUS * 3};
+    }
+    float offset = width / 2 - layout.positions[0].x;  // Center the root.
+    for (LayoutPoint &p : layout.positions) p.x += offset;
+}
+
+#endif // TREE_LAYOUT_HPP
@@ -0,0 +1,292 @@
+#ifndef TREE_RENDERER_HPP
+#define TREE_RENDERER_HPP
+
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include "layout_grid.hpp"
+#include "tree_layout.hpp"
+using namespace std;
+
+const size_t CIRCLE_SEGMENTS = 24;  // Triangles per node circle at full size.
+const size_t MIN_CIRCLE_SEGMENTS = 6;  // Triangles per node circle when nodes are tiny on screen.
+const sf::Color NODE_COLOR(48, 155, 141);  // Fill color of the node circles.
+const sf::Color EDGE_COLOR = sf::Color::Black;  // Color of the parent-child lines.
+const unsigned LABEL_SIZE = 20;  // Character size of the node labels.
+const float MIN_NODE_PIXELS = 2.5f;  // Below this on-screen radius, nodes collapse into per-cell aggregates.
+const float MIN_LABEL_PIXELS = 6.0f;  // Below this on-screen character size, labels are skipped.
+const float AGGREGATE_CELL_PIXELS = 6.0f;  // Smallest on-screen size of one aggregate cell.
+const float ZOOM_STEP = 1.1f;  // View scale change per wheel notch or key press.
+
+// Counts of window wake-ups that redrew the tree and of those that had nothing new to show.
+struct RenderStats {
+    uint64_t rendered = 0;  // Frames cleared, drawn and displayed.
+    uint64_t skipped = 0;  // Events handled without redrawing.
+};
+
+/*
+ * Draws a layout with one vertex-array draw call each for edges, circles and label glyphs.
+ *
+ * Only what intersects the current view is submitted: a LayoutGrid finds the visible nodes and edges, and
+ * when nodes would be smaller than a few pixels the renderer draws one aggregate box per grid cell instead
+ * (picking the grid level so the number of boxes stays bounded by the window size). The batches are only
+ * rebuilt when the layout or the view changes.
+ */
+template <typename T>
+class TreeRenderer {
+private:
+    sf::VertexArray edges;  // Visible parent-child lines, as sf::Lines.
+    sf::VertexArray circles;  // Visible node circles or aggregates, as sf::Triangles.
+    sf::VertexArray glyphs;  // Visible label characters, as textured sf::Triangles from the font atlas.
+    LayoutGrid grid;  // Spatial index over the layout.
+    const TreeLayout<T> *layout;  // Layout being drawn.
+    const sf::Font *font;  // Font the glyphs are taken from.
+    uint64_t version;  // Layout version the batches were built from.
+    float width;  // Layout width the batches were built from.
+    sf::FloatRect visible;  // View rectangle the batches were built for.
+    float pixels_per_unit;  // Scale the batches were built for.
+    vector<uint32_t> edge_stamp;  // Last rebuild that emitted each edge, to skip repeats from the grid.
+    uint32_t stamp;
+    size_t drawn_nodes;  // Nodes (or aggregated nodes) in the current batches.
+
+    // Appends the glyph quads of one label, centered on center.
+    void append_glyphs(string_view label, sf::Vector2f center) {
+        float pen = 0, left = 0, right = 0, top = 0, bottom = 0;
+        uint32_t previous = 0;
+        size_t first = glyphs.getVertexCount();
+        for (char c : label) {
+            uint32_t code = static_cast<unsigned char>(c);
+            pen += font->getKerning(previous, code, LABEL_SIZE);
+            const sf::Glyph &glyph = font->getGlyph(code, LABEL_SIZE, false);
+            float x0 = pen + glyph.bounds.left, y0 = glyph.bounds.top;  // Relative to the baseline.
+            float x1 = x0 + glyph.bounds.width, y1 = y0 + glyph.bounds.height;
+            float u0 = static_cast<float>(glyph.textureRect.left), v0 = static_cast<float>(glyph.textureRect.top);
+            float u1 = u0 + glyph.textureRect.width, v1 = v0 + glyph.textureRect.height;
+            sf::Color color = sf::Color::Black;
+            glyphs.append(sf::Vertex(sf::Vector2f(x0, y0), color, sf::Vector2f(u0, v0)));
+            glyphs.append(sf::Vertex(sf::Vector2f(x1, y0), color, sf::Vector2f(u1, v0)));
+            glyphs.append(sf::Vertex(sf::Vector2f(x0, y1), color, sf::Vector2f(u0, v1)));
+            glyphs.append(sf::Vertex(sf::Vector2f(x0, y1), color, sf::Vector2f(u0, v1)));
+            glyphs.append(sf::Vertex(sf::Vector2f(x1, y0), color, sf::Vector2f(u1, v0)));
+            glyphs.append(sf::Vertex(sf::Vector2f(x1, y1), color, sf::Vector2f(u1, v1)));
+            left = min(left, x0);
+            right = max(right, x1);
+            top = min(top, y0);
+            bottom = max(bottom, y1);
+            pen += glyph.advance;
+            previous = code;
+        }
+
+        float dx = center.x - (left + right) / 2, dy = center.y - (top + bottom) / 2;  // Center the ink box.
+        for (size_t v = first; v < glyphs.getVertexCount(); v++) {
+            glyphs[v].position.x += dx;
+            glyphs[v].position.y += dy;
+        }
+    }
+
+    void append_box(float x0, float y0, float x1, float y1, sf::Color color) {
+        circles.append(sf::Vertex(sf::Vector2f(x0, y0), color));
+        circles.append(sf::Vertex(sf::Vector2f(x1, y0), color));
+        circles.append(sf::Vertex(sf::Vector2f(x0, y1), color));
+        circles.append(sf::Vertex(sf::Vector2f(x0, y1), color));
+        circles.append(sf::Vertex(sf::Vector2f(x1, y0), color));
+        circles.append(sf::Vertex(sf::Vector2f(x1, y1), color));
+    }
+
+    // Rebuilds the batches for the nodes inside the given view rectangle.
+    void rebuild(const sf::FloatRect &rect, float scale) {
+        edges.clear();
+        circles.clear();
+        glyphs.clear();
+        drawn_nodes = 0;
+        float x0 = rect.left, y0 = rect.top, x1 = rect.left + rect.width, y1 = rect.top + rect.height;
+
+        if (NODE_RADIUS * scale < MIN_NODE_PIXELS) {  // Too small to tell apart: draw aggregates.
+            size_t level = 0;
+            while (level + 1 < grid.level_count() && grid.cell_size(level) * scale < AGGREGATE_CELL_PIXELS) level++;
+            float pad = max(NODE_RADIUS, 0.5f / scale);  // Keep every aggregate at least a pixel wide.
+            grid.for_each_cell(level, x0, y0, x1, y1, [&](const GridCell &cell) {
+                append_box(cell.min_x - pad, cell.min_y - pad, cell.max_x + pad, cell.max_y + pad, NODE_COLOR);
+                drawn_nodes += cell.count;
+            });
+            return;
+        }
+
+        stamp++;
+        grid.for_each_edge(x0, y0, x1, y1, [&](uint32_t child) {
+            if (edge_stamp[child] == stamp) return;  // Already emitted from another cell.
+            edge_stamp[child] = stamp;
+            const LayoutPoint &a = layout->positions[child], &b = layout->positions[layout->parents[child]];
+            edges.append(sf::Vertex(sf::Vector2f(a.x, a.y), EDGE_COLOR));
+            edges.append(sf::Vertex(sf::Vector2f(b.x, b.y), EDGE_COLOR));
+        });
+
+        size_t segments = static_cast<size_t>(NODE_RADIUS * scale / 2);  // Fewer triangles for small circles.
+        segments = max(MIN_CIRCLE_SEGMENTS, min(CIRCLE_SEGMENTS, segments));
+        sf::Vector2f unit[CIRCLE_SEGMENTS + 1];  // Circle outline shared by every node.
+        for (size_t s = 0; s <= segments; s++) {
+            float angle = 2 * static_cast<float>(M_PI) * s / segments;
+            unit[s] = sf::Vector2f(cos(angle) * NODE_RADIUS, sin(angle) * NODE_RADIUS);
+        }
+        bool labels = font != nullptr && LABEL_SIZE * scale >= MIN_LABEL_PIXELS;
+
+        float margin = NODE_RADIUS * 2;  // Nodes just outside the view can still overlap it.
+        grid.for_each_node(x0 - margin, y0 - margin, x1 + margin, y1 + margin, [&](uint32_t i) {
+            sf::Vector2f center(layout->positions[i].x, layout->positions[i].y);
+            for (size_t s = 0; s < segments; s++) {
+                circles.append(sf::Vertex(center, NODE_COLOR));
+                circles.append(sf::Vertex(sf::Vector2f(center.x + unit[s].x, center.y + unit[s].y), NODE_COLOR));
+                circles.append(sf::Vertex(sf::Vector2f(center.x + unit[s + 1].x, center.y + unit[s + 1].y), NODE_COLOR));
+            }
+            if (labels) append_glyphs(layout->label(i), center);
+            drawn_nodes++;
+        });
+    }
+
+public:
+    TreeRenderer()
+        : edges(sf::Lines), circles(sf::Triangles), glyphs(sf::Triangles), layout(nullptr), font(nullptr),
+          version(UINT64_MAX), width(-1), pixels_per_unit(0), stamp(0), drawn_nodes(0) {}
+
+    // Points the renderer at a layout; the spatial index is rebuilt only if the layout changed.
+    void update(const TreeLayout<T> &tree_layout, const sf::Font &label_font) {
+        if (&tree_layout == layout && tree_layout.version == version && tree_layout.width == width && font == &label_font) return;
+        layout = &tree_layout;
+        version = tree_layout.version;
+        width = tree_layout.width;
+        font = &label_font;
+        grid.update(tree_layout);
+        edge_stamp.assign(tree_layout.size(), 0);
+        stamp = 0;
+        pixels_per_unit = 0;  // Force a rebuild on the next draw.
+    }
+
+    void draw(sf::RenderWindow &window) {
+        if (layout == nullptr) return;
+        const sf::View &view = window.getView();
+        sf::FloatRect rect(view.getCenter().x - view.getSize().x / 2, view.getCenter().y - view.getSize().y / 2,
+                           view.getSize().x, view.getSize().y);
+        float scale = static_cast<float>(window.getSize().x) / view.getSize().x;
+        if (scale != pixels_per_unit || rect.left != visible.left || rect.top != visible.top ||
+            rect.width != visible.width || rect.height != visible.height) {
+            rebuild(rect, scale);  // Only when panned, zoomed, resized or re-laid out.
+            visible = rect;
+            pixels_per_unit = scale;
+        }
+
+        window.draw(edges);  // Lines first so the circles cover their ends.
+        window.draw(circles);
+        if (font != nullptr) window.draw(glyphs, sf::RenderStates(&font->getTexture(LABEL_SIZE)));  // Text on top.
+    }
+
+    size_t get_drawn_nodes() const { return drawn_nodes; }  // Nodes submitted in the last rebuild.
+};
+
+// Pan and zoom state of a tree window: the wheel zooms around the cursor, dragging pans, arrows and +/-
+// work too, and Home fits the whole layout.
+class ViewNavigator {
+private:
+    sf::View view;
+    bool dragging;
+    sf::Vector2i last_mouse;
+    sf::Vector2u window_size;  // Size before the last Resized event; window.getSize() already holds the new one.
+
+    void zoom_at(const sf::RenderWindow &window, sf::Vector2i pixel, float factor) {
+        sf::Vector2f before = window.mapPixelToCoords(pixel, view);
+        view.zoom(factor);
+        sf::Vector2f after = window.mapPixelToCoords(pixel, view);
+        view.move(before.x - after.x, before.y - after.y);  // Keep the point under the cursor fixed.
+    }
+
+public:
+    explicit ViewNavigator(const sf::RenderWindow &window)
+        : view(window.getDefaultView()), dragging(false), window_size(window.getSize()) {}
+
+    const sf::View &get_view() const { return view; }
+
+    // Fits the view around a layout, keeping the window's aspect ratio.
+    template <typename T>
+    void fit(const TreeLayout<T> &layout, const sf::RenderWindow &window) {
+        if (layout.size() == 0) return;
+        float x0 = layout.positions[0].x, x1 = x0, y0 = layout.positions[0].y, y1 = y0;
+        for (const LayoutPoint &p : layout.positions) {
+            x0 = min(x0, p.x);
+            x1 = max(x1, p.x);
+            y0 = min(y0, p.y);
+            y1 = max(y1, p.y);
+        }
+        float w = x1 - x0 + NODE_RADIUS * 4, h = y1 - y0 + NODE_RADIUS * 4;
+        float aspect = static_cast<float>(window.getSize().x) / window.getSize().y;
+        if (w / h < aspect) w = h * aspect;
+        else h = w / aspect;
+        view.setCenter((x0 + x1) / 2, (y0 + y1) / 2);
+        view.setSize(w, h);
+    }
+
+    // Fits the view only if part of the layout lies outside the window at the default zoom.
+    template <typename T>
+    void fit_if_outside(const TreeLayout<T> &layout, const sf::RenderWindow &window) {
+        for (const LayoutPoint &p : layout.positions) {
+            if (p.x < NODE_RADIUS || p.x > window.getSize().x - NODE_RADIUS || p.y > window.getSize().y - NODE_RADIUS) {
+                fit(layout, window);  // Wider or deeper than the window: start zoomed out.
+                return;
+            }
+        }
+    }
+
+    // Applies one window event to the view. Returns true if the view changed.
+    template <typename T>
+    bool handle(const sf::Event &event, const sf::RenderWindow &window, const TreeLayout<T> &layout) {
+        switch (event.type) {
+            case sf::Event::Resized: {
+                float scale = view.getSize().x / max(1.0f, static_cast<float>(window_size.x));  // World units per old pixel.
+                view.setSize(event.size.width * scale, event.size.height * scale);  // Keep the zoom level.
+                window_size = sf::Vector2u(event.size.width, event.size.height);
+                return true;
+            }
+            case sf::Event::MouseWheelScrolled:
+                zoom_at(window, sf::Vector2i(event.mouseWheelScroll.x, event.mouseWheelScroll.y),
+                        event.mouseWheelScroll.delta > 0 ? 1 / ZOOM_STEP : ZOOM_STEP);
+                return true;
+            case sf::Event::MouseButtonPressed:
+                if (event.mouseButton.button == sf::Mouse::Left) {
+                    dragging = true;
+                    last_mouse = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+                }
+                return false;
+            case sf::Event::MouseButtonReleased:
+                if (event.mouseButton.button == sf::Mouse::Left) dragging = false;
+                return false;
+            case sf::Event::MouseMoved: {
+                if (!dragging) return false;
+                sf::Vector2i mouse(event.mouseMove.x, event.mouseMove.y);
+                sf::Vector2f from = window.mapPixelToCoords(last_mouse, view), to = window.mapPixelToCoords(mouse, view);
+                view.move(from.x - to.x, from.y - to.y);
+                last_mouse = mouse;
+                return true;
+            }
+            case sf::Event::KeyPressed: {
+                sf::Vector2f step(view.getSize().x / 10, view.getSize().y / 10);
+                switch (event.key.code) {
+                    case sf::Keyboard::Left: view.move(-step.x, 0); return true;
+                    case sf::Keyboard::Right: view.move(step.x, 0); return true;
+                    case sf::Keyboard::Up: view.move(0, -step.y); return true;
+                    case sf::Keyboard::Down: view.move(0, step.y); return true;
+                    case sf::Keyboard::Add:
+                    case sf::Keyboard::Equal: view.zoom(1 / ZOOM_STEP); return true;
+                    case sf::Keyboard::Subtract:
+                    case sf::Keyboard::Hyphen: view.zoom(ZOOM_STEP); return true;
+                    case sf::Keyboard::Home: fit(layout, window); return true;
+                    default: return false;
+                }
+            }
+            default:
+                return false;
+        }
+    }
+};
+
+#endif // TREE_RENDERER_HPP
@@ -0,0 +1,201 @@
+#ifndef TREE_VIEWER_HPP
+#define TREE_VIEWER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include "font_cache.hpp"
+#include "tree.hpp"
+#include "tree_layout.hpp"
+#include "tree_renderer.hpp"
+using namespace std;
+
+const chrono::milliseconds VIEWER_POLL_INTERVAL(10);  // Longest wait for a snapshot before checking for input.
+const float VIEWER_SLOT_GAP = NODE_DISTANCE * 2;  // Horizontal gap between trees shown in one window.
+const float VIEWER_WIDTH = 750;  // Initial window size and layout width of the snapshots.
+const float VIEWER_HEIGHT = 650;
+
+/*
+ * SFML window on a background thread that shows tree snapshots without blocking the caller.
+ *
+ * show() takes an immutable snapshot of the tree's layout and labels and queues it; the producer keeps
+ * running and may mutate or destroy the tree right away. The viewer thread picks up the newest snapshot of
+ * each slot and redraws only when a snapshot arrived or the view changed. A viewer with several slots shows
+ * several trees side by side in one window; several viewers open parallel windows.
+ *
+ * Windows on background threads work on Linux and Windows; macOS requires them on the main thread.
+ */
+template <typename T>
+class TreeViewer {
+private:
+    string title;
+    mutable mutex lock;  // Guards queue, stop_requested, window_open and stats.
+    condition_variable wake;
+    deque<pair<size_t, shared_ptr<const TreeLayout<T>>>> queue;  // Snapshots not yet picked up, with their slot.
+    bool stop_requested;
+    bool window_open;
+    RenderStats stats;
+    vector<shared_ptr<const TreeLayout<T>>> slots;  // Newest snapshot per slot; viewer thread only.
+    thread worker;
+
+    // Places every slot's snapshot next to the previous one in a single layout.
+    void merge(TreeLayout<T> &scene) const {
+        uint64_t version = scene.version + 1;
+        scene = TreeLayout<T>();
+        scene.version = version;
+        scene.width = 0;
+        scene.label_offsets.assign(1, 0);
+        float right = 0;  // Right edge of the slots placed so far.
+        for (const auto &slot : slots) {
+            if (slot == nullptr || slot->size() == 0) continue;
+            float x0 = slot->positions[0].x, x1 = x0;
+            for (const LayoutPoint &p : slot->positions) {
+                x0 = min(x0, p.x);
+                x1 = max(x1, p.x);
+            }
+            float dx = (scene.size() == 0 ? 0 : right + VIEWER_SLOT_GAP) - x0;
+            uint32_t base = static_cast<uint32_t>(scene.size());
+            for (size_t i = 0; i < slot->size(); i++) {
+                scene.positions.push_back({slot->positions[i].x + dx, slot->positions[i].y});
+                scene.parents.push_back(slot->parents[i] == NO_PARENT ? NO_PARENT : slot->parents[i] + base);
+                scene.label_offsets.push_back(static_cast<uint32_t>(scene.label_text.size()) + slot->label_offsets[i + 1]);
+            }
+            scene.label_text.insert(scene.label_text.end(), slot->label_text.begin(), slot->label_text.end());
+            right = x1 + dx;
+            scene.width = right;
+        }
+    }
+
+    void run() {
+        SharedFont &labels = shared_font();  // One parsed font for all viewers; labels stay blank if it is missing.
+
+        sf::RenderWindow window(sf::VideoMode(static_cast<unsigned>(VIEWER_WIDTH), static_cast<unsigned>(VIEWER_HEIGHT)), title);
+        window.setVerticalSyncEnabled(true);
+        ViewNavigator navigator(window);
+        TreeRenderer<T> renderer;
+        TreeLayout<T> scene;
+        bool fitted = false;  // Fit the view once, when the first trees arrive.
+        bool dirty = true;
+
+        while (window.isOpen()) {
+            bool woke = false;
+            sf::Event event;
+            while (window.pollEvent(event)) {
+                woke = true;
+                if (event.type == sf::Event::Closed) window.close();
+                else if (event.type == sf::Event::GainedFocus || event.type == sf::Event::MouseEntered) dirty = true;
+                else dirty |= navigator.handle(event, window, scene);
+            }
+
+            bool arrived = false;
+            {
+                unique_lock<mutex> guard(lock);
+                if (!dirty) wake.wait_for(guard, VIEWER_POLL_INTERVAL, [&] { return stop_requested || !queue.empty(); });
+                if (stop_requested) window.close();
+                for (auto &entry : queue) {
+                    if (entry.first >= slots.size()) slots.resize(entry.first + 1);
+                    slots[entry.first] = std::move(entry.second);
+                    arrived = true;
+                }
+                queue.clear();
+            }
+            if (!window.isOpen()) break;
+
+            if (arrived) {
+                merge(scene);
+                if (!fitted && scene.size() > 0) {
+                    navigator.fit_if_outside(scene, window);
+                    fitted = true;
+                }
+                dirty = true;
+            }
+            if (!dirty) {
+                if (woke) {
+                    lock_guard<mutex> guard(lock);
+                    stats.skipped++;
+                }
+                continue;
+            }
+
+            window.setView(navigator.get_view());
+            window.clear(sf::Color::White);
+            {
+                lock_guard<mutex> guard(labels.lock);  // Glyphs are added to the shared atlas while drawing.
+                renderer.update(scene, labels.font);
+                renderer.draw(window);
+            }
+            window.display();
+            dirty = false;
+            lock_guard<mutex> guard(lock);
+            stats.rendered++;
+        }
+
+        lock_guard<mutex> guard(lock);
+        window_open = false;
+        queue.clear();  // Snapshots that arrived while the window was closing.
+        wake.notify_all();
+    }
+
+public:
+    explicit TreeViewer(string window_title = "EX2")
+        : title(std::move(window_title)), stop_requested(false), window_open(true) {
+        worker = thread([this] { run(); });
+    }
+
+    TreeViewer(const TreeViewer &) = delete;
+    TreeViewer &operator=(const TreeViewer &) = delete;
+
+    ~TreeViewer() {
+        close();
+        if (worker.joinable()) worker.join();
+    }
+
+    // Queues a snapshot of the tree for the given slot. Returns immediately; the tree may change afterwards.
+    // Does nothing once the window is closed.
+    template <int K>
+    void show(Tree<T, K> &tree, size_t slot = 0) {
+        if (!is_open()) return;  // Skip copying the layout for a window nobody sees.
+        show(tree.snapshot(VIEWER_WIDTH), slot);
+    }
+
+    void show(shared_ptr<const TreeLayout<T>> snapshot, size_t slot = 0) {
+        lock_guard<mutex> guard(lock);
+        if (!window_open || stop_requested) return;  // Nobody would pick it up: drop it instead of queueing.
+        queue.emplace_back(slot, std::move(snapshot));
+        wake.notify_all();
+    }
+
+    bool is_open() const {
+        lock_guard<mutex> guard(lock);
+        return window_open;
+    }
+
+    // Blocks until the user closes the window.
+    void wait() {
+        unique_lock<mutex> guard(lock);
+        wake.wait(guard, [&] { return !window_open; });
+    }
+
+    // Asks the viewer thread to close the window; does not wait for it.
+    void close() {
+        lock_guard<mutex> guard(lock);
+        stop_requested = true;
+        wake.notify_all();
+    }
+
+    RenderStats get_render_stats() const {
+        lock_guard<mutex> guard(lock);
+        return stats;
+    }
+};
+
+#endif // TREE_VIEWER_HPP
@@ -0,0 +1,56 @@
+#ifndef VALUE_FORMAT_HPP
+#define VALUE_FORMAT_HPP
+
+#include <charconv>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+using namespace std;
+
+// Appends the display form of a value to out: numbers via to_chars (floating point with one decimal,
+// as the GUI always showed them), strings verbatim, anything else through its operator<<. Lossy, so only
+// for drawn labels; data exports use append_exact.
+template <typename T>
+void append_label(vector<char> &out, const T &value) {
+    if constexpr (is_same<T, string>::value) {
+        out.insert(out.end(), value.begin(), value.end());
+    } else if constexpr (is_arithmetic<T>::value) {
+        char buffer[400];  // Room for any double in fixed notation.
+        to_chars_result result;
+        if constexpr (is_floating_point<T>::value) {
+            result = to_chars(buffer, buffer + sizeof(buffer), value, chars_format::fixed, 1);
+        } else {
+            result = to_chars(buffer, buffer + sizeof(buffer), value);
+        }
+        out.insert(out.end(), buffer, result.ptr);
+    } else {
+        ostringstream oss;
+        oss << fixed << setprecision(1) << value;  // Fallback for types without a fast path.
+        string text = oss.str();
+        out.insert(out.end(), text.begin(), text.end());
+    }
+}
+
+// Appends a lossless form of a value to out for data exports: numbers via to_chars in the shortest form that
+// reads back to the same value, strings verbatim, anything else through its operator<< with enough digits to
+// round-trip doubles.
+template <typename T>
+void append_exact(vector<char> &out, const T &value) {
+    if constexpr (is_same<T, string>::value) {
+        out.insert(out.end(), value.begin(), value.end());
+    } else if constexpr (is_arithmetic<T>::value) {
+        char buffer[64];  // Enough for the shortest form of any arithmetic value.
+        to_chars_result result = to_chars(buffer, buffer + sizeof(buffer), value);
+        out.insert(out.end(), buffer, result.ptr);
+    } else {
+        ostringstream oss;
+        oss << setprecision(numeric_limits<double>::max_digits10) << value;
+        string text = oss.str();
+        out.insert(out.end(), text.begin(), text.end());
+    }
+}
+
+#endif // VALUE_FORMAT_HPP
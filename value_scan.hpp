@@ -0,0 +1,188 @@
+#ifndef VALUE_SCAN_HPP
+#define VALUE_SCAN_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "node.hpp"
+#include "simd.hpp"
+using namespace std;
+
+namespace scan_kernels {
+
+#ifdef EX2_X86_SIMD
+inline size_t first_bit(uint32_t mask) { return static_cast<size_t>(__builtin_ctz(mask)); }
+
+// Each kernel returns the index of the first element in [i, n) equal to value, or the first index it did
+// not look at (a multiple of its width); the scalar loop finishes the tail.
+
+__attribute__((target("avx2"))) inline size_t find_int32_avx2(const int32_t *data, size_t i, size_t n, int32_t value) {
+    __m256i key = _mm256_set1_epi32(value);
+    for (; i + 16 <= n; i += 16) {  // Two registers per step: 16 values.
+        __m256i a = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)), key);
+        __m256i b = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 8)), key);
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(a))) |
+                        static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(b))) << 8;
+        if (mask != 0) return i + first_bit(mask);
+    }
+    return i;
+}
+
+__attribute__((target("sse2"))) inline size_t find_int32_sse2(const int32_t *data, size_t i, size_t n, int32_t value) {
+    __m128i key = _mm_set1_epi32(value);
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), key);
+        __m128i b = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 4)), key);
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(a))) |
+                        static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(b))) << 4;
+        if (mask != 0) return i + first_bit(mask);
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) inline size_t find_int64_avx2(const int64_t *data, size_t i, size_t n, int64_t value) {
+    __m256i key = _mm256_set1_epi64x(value);
+    for (; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)), key);
+        __m256i b = _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 4)), key);
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(a))) |
+                        static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(b))) << 4;
+        if (mask != 0) return i + first_bit(mask);
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) inline size_t find_float_avx2(const float *data, size_t i, size_t n, float value) {
+    __m256 key = _mm256_set1_ps(value);
+    for (; i + 16 <= n; i += 16) {
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), key, _CMP_EQ_OQ))) |
+                        static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i + 8), key, _CMP_EQ_OQ))) << 8;
+        if (mask != 0) return i + first_bit(mask);
+    }
+    return i;
+}
+
+__attribute__((target("sse2"))) inline size_t find_float_sse2(const float *data, size_t i, size_t n, float value) {
+    __m128 key = _mm_set1_ps(value);
+    for (; i + 8 <= n; i += 8) {
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(data + i), key))) |
+                        static_cast<uint32_t>(_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(data + i + 4), key))) << 4;
+        if (mask != 0) return i + first_bit(mask);
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) inline size_t find_double_avx2(const double *data, size_t i, size_t n, double value) {
+    __m256d key = _mm256_set1_pd(value);
+    for (; i + 8 <= n; i += 8) {
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(data + i), key, _CMP_EQ_OQ))) |
+                        static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(data + i + 4), key, _CMP_EQ_OQ))) << 4;
+        if (mask != 0) return i + first_bit(mask);
+    }
+    return i;
+}
+
+__attribute__((target("sse2"))) inline size_t find_double_sse2(const double *data, size_t i, size_t n, double value) {
+    __m128d key = _mm_set1_pd(value);
+    for (; i + 4 <= n; i += 4) {
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(data + i), key))) |
+                        static_cast<uint32_t>(_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(data + i + 2), key))) << 2;
+        if (mask != 0) return i + first_bit(mask);
+    }
+    return i;
+}
+#endif
+
+// Vector part of the search for types with a kernel; returns i unchanged for the rest.
+template <typename T>
+size_t find_vector(const T *data, size_t i, size_t n, const T &value, SimdLevel level) {
+#ifdef EX2_X86_SIMD
+    if (level == SimdLevel::SCALAR) return i;
+    if constexpr (is_integral<T>::value && !is_same<T, bool>::value && sizeof(T) == 4) {
+        int32_t key;
+        memcpy(&key, &value, sizeof(key));  // Equality of 4-byte integers is equality of their bits.
+        const int32_t *words = reinterpret_cast<const int32_t *>(data);
+        return level == SimdLevel::AVX2 ? find_int32_avx2(words, i, n, key) : find_int32_sse2(words, i, n, key);
+    } else if constexpr (is_integral<T>::value && sizeof(T) == 8) {
+        int64_t key;
+        memcpy(&key, &value, sizeof(key));
+        return level == SimdLevel::AVX2 ? find_int64_avx2(reinterpret_cast<const int64_t *>(data), i, n, key) : i;
+    } else if constexpr (is_same<T, float>::value) {
+        return level == SimdLevel::AVX2 ? find_float_avx2(data, i, n, value) : find_float_sse2(data, i, n, value);
+    } else if constexpr (is_same<T, double>::value) {
+        return level == SimdLevel::AVX2 ? find_double_avx2(data, i, n, value) : find_double_sse2(data, i, n, value);
+    }
+#endif
+    (void)data, (void)n, (void)value, (void)level;
+    return i;
+}
+
+}  // namespace scan_kernels
+
+// Index of the first element in [begin, n) equal to value, or n. 4- and 8-byte integers, float and double
+// are compared 8 to 16 at a time with AVX2 (4 to 8 with SSE2); other types element by element.
+template <typename T>
+size_t find_equal(const T *data, size_t begin, size_t n, const T &value, SimdLevel level = simd_level()) {
+    size_t i = scan_kernels::find_vector(data, begin, n, value, level);
+    if (i < n && data[i] == value) return i;  // Found by the vector loop.
+    for (; i < n; i++) {
+        if (data[i] == value) return i;
+    }
+    return n;
+}
+
+/*
+ * Contiguous pre-order copy of a tree's values with the matching nodes, so numeric lookups become a
+ * vector scan instead of pointer chasing. Rebuilt by the tree when it changed since the last build.
+ */
+template <typename T>
+class ValueScan {
+private:
+    AlignedVector<T> values;  // Values in pre-order.
+    vector<Node<T> *> nodes;  // Node holding each value.
+    uint64_t version = UINT64_MAX;  // Tree version the copy was taken from.
+
+public:
+    bool is_current(uint64_t tree_version) const { return version == tree_version; }
+
+    void clear() {  // Releases the copy.
+        values = AlignedVector<T>();
+        nodes = vector<Node<T> *>();
+        version = UINT64_MAX;
+    }
+
+    void update(Node<T> *root, uint64_t tree_version) {
+        values.clear();
+        nodes.clear();
+        vector<Node<T> *> stack;
+        if (root != nullptr) stack.push_back(root);
+        while (!stack.empty()) {
+            Node<T> *node = stack.back();
+            stack.pop_back();
+            values.push_back(node->get_value());
+            nodes.push_back(node);
+            const auto &children = node->get_children();
+            for (size_t i = children.size(); i > 0; i--) stack.push_back(children[i - 1]);  // Pop left to right.
+        }
+        version = tree_version;
+    }
+
+    // First node in pre-order holding value, like the recursive find_node, or nullptr.
+    Node<T> *find_first(const T &value, SimdLevel level = simd_level()) const {
+        size_t i = find_equal(values.data(), 0, values.size(), value, level);
+        return i < values.size() ? nodes[i] : nullptr;
+    }
+
+    // Every node holding value, in pre-order.
+    vector<Node<T> *> find_all(const T &value, SimdLevel level = simd_level()) const {
+        vector<Node<T> *> found;
+        for (size_t i = find_equal(values.data(), 0, values.size(), value, level); i < values.size();
+             i = find_equal(values.data(), i + 1, values.size(), value, level)) {
+            found.push_back(nodes[i]);
+        }
+        return found;
+    }
+};
+
+#endif // VALUE_SCAN_HPP